@@ -0,0 +1,198 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_ACTIONSCHEDULER_H
+#define CPPREADY_TRADER_GO_ACTIONSCHEDULER_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <ready_trader_go/ratelimiter.h>
+#include <ready_trader_go/types.h>
+
+// A new order waiting to be sent.
+struct PendingQuote
+{
+    ReadyTraderGo::Side mSide = ReadyTraderGo::Side::SELL;
+    unsigned long mPrice = 0;
+    unsigned long mVolume = 0;
+    ReadyTraderGo::Lifespan mLifespan = ReadyTraderGo::Lifespan::FILL_AND_KILL;
+    unsigned long mSequenceNumber = 0;
+};
+
+// Outbound messages waiting for room under the message limit, sent in
+// order of importance: hedges, then cancels, then new orders. Redundant
+// actions are merged while they wait: hedges are netted into at most one
+// order, an order is cancelled at most once and a new quote replaces an
+// unsent one on the same side.
+//
+// Sink receives the actions as they are sent, through
+//     void execute_hedge(Side side, unsigned long volume);
+//     void execute_cancel(unsigned long client_order_id);
+//     void execute_quote(const PendingQuote& quote);
+// and is asked before each quote is sent whether another order would stay
+// within the exchange's limits, through
+//     bool can_add_order();
+// A quote that would not is dropped.
+template<typename Sink>
+class ActionScheduler
+{
+public:
+    // New orders are only sent while quoteReserve messages remain for
+    // hedges and cancels.
+    ActionScheduler(Sink& sink, ReadyTraderGo::RateLimiter& limiter, std::size_t limit, std::size_t quoteReserve);
+
+    void Hedge(ReadyTraderGo::Side side, unsigned long volume);
+    void Cancel(unsigned long clientOrderId);
+    void Quote(const PendingQuote& quote);
+
+    // Forget a cancel that is no longer needed, e.g. because the order is done.
+    void DropCancel(unsigned long clientOrderId);
+
+    // Forget unsent quotes, e.g. because the market has moved.
+    void DropQuotes() { mHasQuote = {}; }
+
+    bool IsCancelPending(unsigned long clientOrderId) const;
+
+    // Whether a quote is waiting to be sent on the given side.
+    bool IsQuoteHeld(ReadyTraderGo::Side side) const { return mHasQuote[static_cast<std::size_t>(side)]; }
+    std::size_t GetHeldQuoteCount() const { return mHasQuote[0] + mHasQuote[1]; }
+
+    // Whether the messages used leave room for a new order as well as the
+    // reserve for hedges and cancels. Quotes are only sent when this holds.
+    bool HasRoomForQuote() { return HasRoomForQuote(mLimiter.GetUsed()); }
+
+private:
+    bool HasRoomForQuote(std::size_t used) const { return used + mQuoteReserve < mLimit; }
+    void Drain();
+
+    Sink& mSink;
+    ReadyTraderGo::RateLimiter& mLimiter;
+    std::size_t mLimit;
+    std::size_t mQuoteReserve;
+
+    // Net volume to hedge: positive to sell, negative to buy.
+    long mHedgeVolume = 0;
+    std::vector<unsigned long> mCancels;
+    std::array<PendingQuote, 2> mQuotes = {};
+    std::array<bool, 2> mHasQuote = {};
+    bool mIsWaiting = false;
+};
+
+template<typename Sink>
+ActionScheduler<Sink>::ActionScheduler(Sink& sink,
+                                       ReadyTraderGo::RateLimiter& limiter,
+                                       std::size_t limit,
+                                       std::size_t quoteReserve)
+    : mSink(sink), mLimiter(limiter), mLimit(limit), mQuoteReserve(quoteReserve)
+{
+    mCancels.reserve(ReadyTraderGo::RATE_LIMITER_CAPACITY);
+}
+
+template<typename Sink>
+void ActionScheduler<Sink>::Hedge(ReadyTraderGo::Side side, unsigned long volume)
+{
+    mHedgeVolume += (side == ReadyTraderGo::Side::SELL) ? (long)volume : -(long)volume;
+    Drain();
+}
+
+template<typename Sink>
+void ActionScheduler<Sink>::Cancel(unsigned long clientOrderId)
+{
+    if (!IsCancelPending(clientOrderId))
+        mCancels.push_back(clientOrderId);
+    Drain();
+}
+
+template<typename Sink>
+void ActionScheduler<Sink>::Quote(const PendingQuote& quote)
+{
+    mQuotes[static_cast<std::size_t>(quote.mSide)] = quote;
+    mHasQuote[static_cast<std::size_t>(quote.mSide)] = true;
+    Drain();
+}
+
+template<typename Sink>
+void ActionScheduler<Sink>::DropCancel(unsigned long clientOrderId)
+{
+    mCancels.erase(std::remove(mCancels.begin(), mCancels.end(), clientOrderId), mCancels.end());
+}
+
+template<typename Sink>
+bool ActionScheduler<Sink>::IsCancelPending(unsigned long clientOrderId) const
+{
+    return std::find(mCancels.begin(), mCancels.end(), clientOrderId) != mCancels.end();
+}
+
+template<typename Sink>
+void ActionScheduler<Sink>::Drain()
+{
+    // Actions sent below may schedule more, which this loop picks up.
+    while (true)
+    {
+        const std::size_t used = mLimiter.GetUsed();
+        if (used >= mLimit)
+            break;
+
+        if (mHedgeVolume != 0)
+        {
+            const long volume = mHedgeVolume;
+            mHedgeVolume = 0;
+            mLimiter.Record();
+            if (volume > 0)
+                mSink.execute_hedge(ReadyTraderGo::Side::SELL, (unsigned long)volume);
+            else
+                mSink.execute_hedge(ReadyTraderGo::Side::BUY, (unsigned long)-volume);
+        }
+        else if (!mCancels.empty())
+        {
+            const unsigned long clientOrderId = mCancels.front();
+            mCancels.erase(mCancels.begin());
+            mLimiter.Record();
+            mSink.execute_cancel(clientOrderId);
+        }
+        else if ((mHasQuote[0] || mHasQuote[1]) && HasRoomForQuote(used))
+        {
+            // Orders may have been added since the quote was queued.
+            const std::size_t side = mHasQuote[0] ? 0 : 1;
+            mHasQuote[side] = false;
+            if (mSink.can_add_order())
+            {
+                mLimiter.Record();
+                mSink.execute_quote(mQuotes[side]);
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    // Try again once there is more room.
+    if (!mIsWaiting && (mHedgeVolume != 0 || !mCancels.empty() || mHasQuote[0] || mHasQuote[1]))
+    {
+        mIsWaiting = true;
+        mLimiter.NotifyOnExpiry([this] {
+            mIsWaiting = false;
+            Drain();
+        });
+    }
+}
+
+#endif //CPPREADY_TRADER_GO_ACTIONSCHEDULER_H
@@ -15,6 +15,7 @@
 //     You should have received a copy of the GNU Affero General Public
 //     License along with Ready Trader Go.  If not, see
 //     <https://www.gnu.org/licenses/>.
+#include <algorithm>
 #include <array>
 
 #include <boost/asio/io_context.hpp>
@@ -35,81 +36,74 @@ constexpr int TICK_SIZE_IN_CENTS = 100;
 constexpr int MIN_BID_NEARST_TICK = (MINIMUM_BID + TICK_SIZE_IN_CENTS) / TICK_SIZE_IN_CENTS * TICK_SIZE_IN_CENTS;
 constexpr int MAX_ASK_NEAREST_TICK = MAXIMUM_ASK / TICK_SIZE_IN_CENTS * TICK_SIZE_IN_CENTS;
 
-AutoTrader::AutoTrader(boost::asio::io_context& context) : BaseAutoTrader(context)
+AutoTrader::AutoTrader(boost::asio::io_context& context, ReadyTraderGo::ITimerSource& timers)
+    : BaseAutoTraderT(context),
+      timers(timers),
+      limiter(timers, message_limit, milliseconds(bound_time)),
+      scheduler(*this, limiter, message_limit, order_message_count)
 {
+    SetHedgePrice(Side::SELL, MIN_BID_NEARST_TICK);
+    SetHedgePrice(Side::BUY, MAX_ASK_NEAREST_TICK);
 }
 
-void AutoTrader::insert_event() {
-    /* Insert an message time to the log
-        Delete all message log 1 second before
+void AutoTrader::execute_hedge(Side side, unsigned long volume) {
+    /* Called by the scheduler when a hedge is sent
+        The order id is taken here so that ids reach the exchange in order
     */
-    auto cur = steady_clock::now();
-    long time = duration_cast<milliseconds>(cur - base_time).count();
-    recent_activity.push_back(time);
-    
-    unsigned long index = 0;
-    for (int i = 0 ; i < recent_activity.size(); i++) {
-        if (time - recent_activity[i] > bound_time) {
-            index += 1;
-        } else {
-            break;
-        }
-    }
-    
-    while (index > 0) {
-        recent_activity.erase(recent_activity.begin());
-        index --;
-    }
+    SendHedgeOrder(mNextMessageId++, side, (side == Side::SELL) ? MIN_BID_NEARST_TICK : MAX_ASK_NEAREST_TICK, volume);
 }
 
-void AutoTrader::wait_event_space() {
-    /* Wait until there is an available message slot in the 50/sec limit
-        If not existing currently, wait until the earliest to be deleted
+void AutoTrader::execute_cancel(unsigned long client_order_id) {
+    /* Called by the scheduler when a cancel is sent
     */
-    if (recent_activity.size() < message_limit) {
+    SendCancelOrder(client_order_id);
+}
+
+void AutoTrader::execute_quote(const PendingQuote& quote) {
+    /* Called by the scheduler when a new order is sent
+    */
+    unsigned long id = mNextMessageId;
+
+    // An order the table can't track would never be found on fill or cancel
+    if (orders.Insert(id, quote.mSide, quote.mPrice, quote.mVolume, quote.mSequenceNumber) == nullptr) {
+        RLOG(LG_AT, LogLevel::LL_WARNING) << "order table full, not sending order for price " << quote.mPrice
+                                          << " vol " << quote.mVolume;
         return;
     }
-    
-    RLOG(LG_AT, LogLevel::LL_INFO) << "Waiting for event space";
-
-    while (true) {
-        auto cur = steady_clock::now();
-        long time = duration_cast<milliseconds>(cur - base_time).count();
-        unsigned long index = 0;
-        if (time - recent_activity[0] > bound_time) {
-            for (int i = 0 ; i < recent_activity.size(); i++) {
-                if (time - recent_activity[i] > bound_time) {
-                    index += 1;
-                } else {
-                    break;
-                }
-            }
-            
-            while (index > 0) {
-                recent_activity.erase(recent_activity.begin());
-                index --;
-            }
-            return;
-        }
-    }
+    mNextMessageId++;
+    SendInsertOrder(id, quote.mSide, quote.mPrice, quote.mVolume, quote.mLifespan);
+
+    // Log the action
+    ledger.OnInsert(quote.mSide, quote.mVolume);
+    ledger.Verify(orders);
+
+    RLOG(LG_AT, LogLevel::LL_INFO) << ((quote.mSide == Side::BUY) ? "Hedge Buying Order" : "Hedge Selling Order") << id
+                                   << " for price " << quote.mPrice << " vol " << quote.mVolume
+                                   << " event " << limiter.GetUsed() << " position " << ledger.Position();
 }
 
-void AutoTrader::clear_event() {
-    auto cur = steady_clock::now();
-    long time = duration_cast<milliseconds>(cur - base_time).count();
-    unsigned long index = 0;
-    for (int i = 0 ; i < recent_activity.size(); i++) {
-        if (time - recent_activity[i] > bound_time) {
-            index += 1;
-        } else {
-            break;
-        }
-    }
-    
-    while (index > 0) {
-        recent_activity.erase(recent_activity.begin());
-        index --;
-    }
+bool AutoTrader::can_add_order() {
+    /* Called by the scheduler before a new order is sent
+    */
+    return ledger.ActiveOrderCount() < active_order_limit && !orders.Full();
+}
+
+bool AutoTrader::can_queue_quote(Side side) {
+    /* Whether a new order on this side can be handed to the scheduler
+
+    Quotes the scheduler is holding count towards the active order limit,
+    except one on the same side, which the new order replaces
+    */
+    std::size_t held = scheduler.GetHeldQuoteCount() - (scheduler.IsQuoteHeld(side) ? 1 : 0);
+    return ledger.ActiveOrderCount() + held < active_order_limit && !orders.Full() && scheduler.HasRoomForQuote();
+}
+
+void AutoTrader::cancel_order(OrderTable::Order& order) {
+    /* Cancel an order unless it is already being cancelled
+    */
+    if (order.mState == OrderTable::State::CANCELLING) return;
+    scheduler.Cancel(order.mClientOrderId);
+    order.mState = OrderTable::State::CANCELLING;
 }
 
 unsigned long AutoTrader::weighted_average(const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& volume, const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& price) {
@@ -136,27 +130,18 @@ bool AutoTrader::trader_can_buy(unsigned long count, unsigned long price_to_buy)
     2. We can hold more position
     */
     
-    long to_buy = 0;
-    
-    for (auto order : Bids2Amount) {
-        to_buy += order.second;
-    }
-    
-    tend_to_own = to_buy;
+    long to_buy = ledger.PendingVolume(Side::BUY);
 
     // Delete wash orders
-    for (auto order : Asks2Price) {
-        if (order.second == price_to_buy) {
-            wait_event_space();
+    orders.ForEach(Side::SELL, [&](OrderTable::Order& order) {
+        if (order.mPrice == price_to_buy) {
             // self.logger.info("insert for delete %d wash %d",  sells, len(self.recent_activity))
-            SendCancelOrder(order.first);
-            deleted.emplace(order.first);
-            insert_event();
+            cancel_order(order);
         }
-    }
+    });
     
-    return ongoing_order_num < 10 && (position + to_buy) <= (POSITION_LIMIT - (long)count) &&
-        recent_activity.size() <= (message_limit - order_message_count) && count > 0 && count <= POSITION_LIMIT * 2;
+    return can_queue_quote(Side::BUY) && (ledger.Position() + to_buy) <= (POSITION_LIMIT - (long)count) &&
+        count > 0 && count <= POSITION_LIMIT * 2;
 }
 
 bool AutoTrader::trader_can_sell(unsigned long count, unsigned long price_to_sell) {
@@ -169,45 +154,36 @@ bool AutoTrader::trader_can_sell(unsigned long count, unsigned long price_to_sel
     2. We can hold less position
     */
     
-    long to_sell = 0;
-    
-    for (auto order : Asks2Amount) {
-        to_sell += order.second;
-    }
-    
-    tend_to_sell = to_sell;
+    long to_sell = ledger.PendingVolume(Side::SELL);
 
     // Delete wash orders
-    for (auto order : Bids2Price) {
-        if (order.second == price_to_sell) {
-            wait_event_space();
+    orders.ForEach(Side::BUY, [&](OrderTable::Order& order) {
+        if (order.mPrice == price_to_sell) {
             // self.logger.info("insert for delete %d wash %d",  sells, len(self.recent_activity))
-            SendCancelOrder(order.first);
-            deleted.emplace(order.first);
-            insert_event();
+            cancel_order(order);
         }
-    }
+    });
     
-    return ongoing_order_num < 10 && (position - to_sell) >= -((long)POSITION_LIMIT - (long)count) &&
-        recent_activity.size() <= (message_limit - order_message_count) && count > 0 && count <= POSITION_LIMIT * 2;
+    return can_queue_quote(Side::SELL) && (ledger.Position() - to_sell) >= -((long)POSITION_LIMIT - (long)count) &&
+        count > 0 && count <= POSITION_LIMIT * 2;
 }
 
 void AutoTrader::DisconnectHandler()
 {
-    BaseAutoTrader::DisconnectHandler();
+    BaseAutoTraderT::DisconnectHandler();
     RLOG(LG_AT, LogLevel::LL_INFO) << "execution connection lost";
 }
 
 void AutoTrader::ErrorMessageHandler(unsigned long clientOrderId,
-                                     const std::string& errorMessage)
+                                     ErrorCode errorCode,
+                                     std::string_view errorMessage)
 {
     RLOG(LG_AT, LogLevel::LL_INFO) << "error with order " << clientOrderId << ": " << errorMessage;
-    if (clientOrderId != 0 && ((Asks2Seq.count(clientOrderId) == 1) || (Bids2Seq.count(clientOrderId) == 1)))
+    OrderTable::Order* order = (clientOrderId != 0) ? orders.Find(clientOrderId) : nullptr;
+    if (order != nullptr)
     {
         //OrderStatusMessageHandler(clientOrderId, 0, 0, 0);
-        wait_event_space();
-        SendCancelOrder(clientOrderId);
-        insert_event();
+        cancel_order(*order);
     }
 }
 
@@ -227,35 +203,16 @@ void AutoTrader::cleanup(unsigned long sequence_number, int Order_Lifespan) {
     */
 
     // Delete the current sequence
-    OB2Mid.erase(sequence_number);
-    OB2BestBidPrice.erase(sequence_number);
-    OB2BestBidVol.erase(sequence_number);
-    OB2BestAskPrice.erase(sequence_number);
-    OB2BestAskVol.erase(sequence_number);
+    books.Erase(sequence_number);
 
     // Delete Old Orders
-    for (auto order : Asks2Seq) {
-        if (recent_activity.size() >= message_limit) {
-            break;
-        }
-        
-        if (sequence_number - order.second > Order_Lifespan && deleted.find(order.first) == deleted.end()) {
-            // self.logger.info("insert for delete %d old %d", order, len(self.recent_activity))
-            SendCancelOrder(order.first);
-            insert_event();
-        }
-    }
-
-    for (auto order : Bids2Seq) {
-        if (recent_activity.size() >= message_limit) {
-            break;
-        }
-        
-        if (sequence_number - order.second > Order_Lifespan && deleted.find(order.first) == deleted.end()) {
-            // self.logger.info("insert for delete %d old %d", order, len(self.recent_activity))
-            SendCancelOrder(order.first);
-            insert_event();
-        }
+    for (auto side : {Side::SELL, Side::BUY}) {
+        orders.ForEach(side, [&](OrderTable::Order& order) {
+            if (sequence_number - order.mSequenceNumber > Order_Lifespan) {
+                // self.logger.info("insert for delete %d old %d", order, len(self.recent_activity))
+                cancel_order(order);
+            }
+        });
     }
 }
 
@@ -264,14 +221,10 @@ void AutoTrader::hedge_all() {
     
     if (unhedged > 0) {
         RLOG(LG_AT, LogLevel::LL_INFO) << "Hedging " << unhedged << " SELLLL";
-        wait_event_space();                                           // Wait for another event space
-        SendHedgeOrder(mNextMessageId++, Side::SELL, MIN_BID_NEARST_TICK, unhedged);
-        insert_event();
+        scheduler.Hedge(Side::SELL, unhedged);
     } else {
         RLOG(LG_AT, LogLevel::LL_INFO) << "Hedging " << unhedged << " BUYYYY";
-        wait_event_space();                                          // Wait for another event space
-        SendHedgeOrder(mNextMessageId++, Side::BUY, MAX_ASK_NEAREST_TICK, (unsigned long)-unhedged);
-        insert_event();
+        scheduler.Hedge(Side::BUY, (unsigned long)-unhedged);
     }
     
     unhedged = 0;
@@ -289,15 +242,11 @@ void AutoTrader::hedge_partial(bool trend) {
     if (unhedged > 0) {
         if (to_be_hedged > unhedged) to_be_hedged = unhedged;
         RLOG(LG_AT, LogLevel::LL_INFO) << "Hedging " << to_be_hedged << " SELLLL";
-        wait_event_space();                                           // Wait for another event space
-        SendHedgeOrder(mNextMessageId++, Side::SELL, MIN_BID_NEARST_TICK, to_be_hedged);
-        insert_event();
+        scheduler.Hedge(Side::SELL, to_be_hedged);
     } else {
         if (to_be_hedged < unhedged) to_be_hedged = unhedged;
         RLOG(LG_AT, LogLevel::LL_INFO) << "Hedging " << to_be_hedged << " BUYYYY";
-        wait_event_space();                                          // Wait for another event space
-        SendHedgeOrder(mNextMessageId++, Side::BUY, MAX_ASK_NEAREST_TICK, (unsigned long)-to_be_hedged);
-        insert_event();
+        scheduler.Hedge(Side::BUY, (unsigned long)-to_be_hedged);
     }
     
     unhedged -= to_be_hedged;
@@ -305,7 +254,7 @@ void AutoTrader::hedge_partial(bool trend) {
 
 // Compare Avg Version
 /*void AutoTrader::handle_hedge(unsigned long future_price) {
-    auto cur = steady_clock::now();
+    auto cur = timers.Now();
     long time = duration_cast<milliseconds>(cur - base_time).count();
     int fail_limit = 2;
     
@@ -372,7 +321,7 @@ void AutoTrader::hedge_partial(bool trend) {
 
 // Local Avg Version
 void AutoTrader::handle_hedge(unsigned long future_price) {
-    auto cur = steady_clock::now();
+    auto cur = timers.Now();
     long time = duration_cast<milliseconds>(cur - base_time).count();
     unsigned long cur_avg = 0;
     
@@ -470,7 +419,6 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
                                    << "; bid prices: " << bidPrices[0]
                                    << "; bid volumes: " << bidVolumes[0];*/
     
-    clear_event();
     //auto cur = steady_clock::now();
     //long long time = duration_cast<milliseconds>(cur - base_time).count();
     //fprintf(stderr, "time %lld\n", time);
@@ -481,28 +429,25 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
     unsigned long mid_price = (bid_mid + ask_mid) / 2;
     
     // Store the data for the first order book came in at a time (either ETF or Futures)
-    if (OB2Mid.find(sequenceNumber) == OB2Mid.end()) {
-        OB2Mid[sequenceNumber] = mid_price;
-        OB2BestAskPrice[sequenceNumber] = askPrices[0];
-        OB2BestAskVol[sequenceNumber] = askVolumes[0];
-        OB2BestBidPrice[sequenceNumber] = bidPrices[0];
-        OB2BestBidVol[sequenceNumber] = bidVolumes[0];
+    const Instrument other = (instrument == Instrument::FUTURE) ? Instrument::ETF : Instrument::FUTURE;
+    const PairedBooks::TopOfBook* paired = books.Find(other, sequenceNumber);
+    if (paired == nullptr) {
+        books.Store(instrument, sequenceNumber, {mid_price, askPrices[0], askVolumes[0], bidPrices[0], bidVolumes[0]});
         return;
     }
 
     // If the obtained data is outdated
     else if (sequenceNumber < last_seq) {
         RLOG(LG_AT, LogLevel::LL_INFO) << "Outdated data for number " << sequenceNumber << " already in " << last_seq;
-        OB2Mid.erase(sequenceNumber);
-        OB2BestAskPrice.erase(sequenceNumber);
-        OB2BestAskVol.erase(sequenceNumber);
-        OB2BestBidPrice.erase(sequenceNumber);
-        OB2BestBidVol.erase(sequenceNumber);
+        books.Erase(sequenceNumber);
         return;
     }
 
     // We get a updated lastest market data (i.e. The largest sequnece time fully obtained that we have not handled)
     else {
+        // Quotes still waiting to be sent are based on older prices
+        scheduler.DropQuotes();
+
         // Initialization of trading variables
         last_seq = sequenceNumber;
         unsigned long etf_price = 0;
@@ -525,9 +470,9 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
         // Set desired Trade price and determine whether we win money by hedging
         if (instrument == Instrument::FUTURE) {
             future_price = mid_price;
-            etf_price = OB2Mid.at(sequenceNumber);
-            target_bid_price = OB2BestBidPrice.at(sequenceNumber);
-            target_ask_price = OB2BestAskPrice.at(sequenceNumber);
+            etf_price = paired->mMid;
+            target_bid_price = paired->mBestBidPrice;
+            target_ask_price = paired->mBestAskPrice;
             
             // Update hedge buy/sell price
             future_buy_price = askPrices[0];
@@ -545,17 +490,17 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
             if (price_to_sell > future_buy_price) {
                 hedge_diff = (long)price_to_sell - (long)future_buy_price;
             }
-            best_volumn = should_buy ? OB2BestAskVol.at(sequenceNumber) : OB2BestBidVol.at(sequenceNumber);
+            best_volumn = should_buy ? paired->mBestAskVolume : paired->mBestBidVolume;
             
         } else {
-            future_price = OB2Mid.at(sequenceNumber);
+            future_price = paired->mMid;
             etf_price = mid_price;
             target_bid_price = bidPrices[0];
             target_ask_price = askPrices[0];
 
             // Update hedge buy/sell price
-            future_buy_price = OB2BestAskPrice.at(sequenceNumber);
-            future_sell_price = OB2BestBidPrice.at(sequenceNumber);
+            future_buy_price = paired->mBestAskPrice;
+            future_sell_price = paired->mBestBidPrice;
 
             // Calculate the price to buy/sell if we would like to
             etf_diff = target_ask_price - target_bid_price;
@@ -584,6 +529,9 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
 
         // TRADE LOOP
         //for (int i = 0; i < order_round; i++) {
+        long position = ledger.Position();
+        unsigned long tend_to_own = ledger.PendingVolume(Side::BUY);
+        unsigned long tend_to_sell = ledger.PendingVolume(Side::SELL);
         if (should_buy && ((POSITION_LIMIT - position - tend_to_own) < order_amount)) {
             order_amount = POSITION_LIMIT - position - tend_to_own;
         }
@@ -596,22 +544,9 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
         if (should_buy && trader_can_buy(order_amount, price_to_buy) && target_bid_price != 0 && target_ask_price != 0 && (etf_diff > 100 || exceed_fee)) {
             //if (unhedged < 0) hedge_all();
             
-            unsigned long cur_bid_id = mNextMessageId++;
-            
             // Send buy order
-            SendInsertOrder(cur_bid_id, Side::BUY, price_to_buy, order_amount, (etf_diff > 100) ? Lifespan::GOOD_FOR_DAY : Lifespan::FILL_AND_KILL);
-            insert_event();
-
-            // Log the action
-            tend_to_own += order_amount;
-            Bids2Seq[cur_bid_id] = sequenceNumber;
-            Bids2Amount[cur_bid_id] = order_amount;
-            Bids2Price[cur_bid_id] = price_to_buy;
-            
-            RLOG(LG_AT, LogLevel::LL_INFO) << "Hedge Buying Order" << cur_bid_id << " for price " << price_to_buy << " vol " << order_amount << " diff is " << hedge_diff
-                            << " event " << recent_activity.size() << " position " << position;
-
-            ongoing_order_num += 1;
+            RLOG(LG_AT, LogLevel::LL_INFO) << "Buying for price " << price_to_buy << " vol " << order_amount << " diff is " << hedge_diff;
+            scheduler.Quote({Side::BUY, price_to_buy, order_amount, (etf_diff > 100) ? Lifespan::GOOD_FOR_DAY : Lifespan::FILL_AND_KILL, sequenceNumber});
 
             if (etf_diff == 100) {
                 RLOG(LG_AT, LogLevel::LL_INFO) << "Paying the fee";
@@ -623,22 +558,9 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
         if (should_sell && trader_can_sell(order_amount, price_to_sell) && target_bid_price != 0 && target_ask_price != 0 && (etf_diff > 100 || exceed_fee)) {
             //if (unhedged > 0) hedge_all();
             
-            unsigned long cur_ask_id = mNextMessageId++;
-
             // Send sell order
-            SendInsertOrder(cur_ask_id, Side::SELL, price_to_sell, order_amount, (etf_diff > 100) ? Lifespan::GOOD_FOR_DAY : Lifespan::FILL_AND_KILL);
-            insert_event();
-
-            // Log the action
-            tend_to_sell += order_amount;
-            Asks2Seq[cur_ask_id] = sequenceNumber;
-            Asks2Amount[cur_ask_id] = order_amount;
-            Asks2Price[cur_ask_id] = price_to_sell;
-            
-            RLOG(LG_AT, LogLevel::LL_INFO) << "Hedge Selling Order" << cur_ask_id << " for price " << price_to_sell << " vol " << order_amount << " diff is " << hedge_diff
-                            << " event " << recent_activity.size() << " position " << position;
-                
-            ongoing_order_num += 1;
+            RLOG(LG_AT, LogLevel::LL_INFO) << "Selling for price " << price_to_sell << " vol " << order_amount << " diff is " << hedge_diff;
+            scheduler.Quote({Side::SELL, price_to_sell, order_amount, (etf_diff > 100) ? Lifespan::GOOD_FOR_DAY : Lifespan::FILL_AND_KILL, sequenceNumber});
 
             if (etf_diff == 100) {
                 RLOG(LG_AT, LogLevel::LL_INFO) << "Paying the fee";
@@ -659,22 +581,32 @@ void AutoTrader::OrderFilledMessageHandler(unsigned long clientOrderId,
                                            unsigned long volume)
 {
     RLOG(LG_AT, LogLevel::LL_INFO) << "order " << clientOrderId << " filled for " << volume
-                                   << " lots at $" << price << " cents " << recent_activity.size() << " events";
+                                   << " lots at $" << price << " cents " << limiter.GetUsed() << " events";
     
     long prev_unhedged = unhedged;
+    long position = ledger.Position();
+    OrderTable::Order* order = orders.Find(clientOrderId);
+
+    // A duplicate fill, or one larger than what is left, would wrap the
+    // order's remaining volume.
+    if (order != nullptr && volume > order->mRemainingVolume)
+    {
+        RLOG(LG_AT, LogLevel::LL_WARNING) << "order " << clientOrderId << " filled for " << volume
+                                          << " lots but only " << order->mRemainingVolume << " remain";
+        volume = std::min<unsigned long>(volume, order->mRemainingVolume);
+        if (volume == 0)
+            return;
+    }
     
     // Bid Order Fill
-    if (Bids2Amount.find(clientOrderId) != Bids2Amount.end()) {
+    if (order != nullptr && order->mSide == Side::BUY) {
         if (position >= 0 || (position + volume < 0)) {
             position_price = (position_price * position + volume * price) / (position + volume);
         } else {
             position_price = price;
         }
-        position += (long)volume;                                     // Current position update
-        tend_to_own -= volume;                                        // To be bought amount update
-        unsigned long remain = Bids2Amount[clientOrderId] - volume; // Specific Order Remain Update
-        Bids2Amount.erase(clientOrderId);
-        Bids2Amount[clientOrderId] = remain;
+        ledger.OnFill(Side::BUY, volume);                             // Position and to be bought amount update
+        order->mRemainingVolume -= volume;                            // Specific Order Remain Update
         
         /*if (unhedged == 0) {
             unhedged += (long)volume;
@@ -689,36 +621,31 @@ void AutoTrader::OrderFilledMessageHandler(unsigned long clientOrderId,
         
         unhedged += (long) volume;
         if (prev_unhedged <= 0 && unhedged >= 0) {
-            auto cur = steady_clock::now();
+            auto cur = timers.Now();
             long time = duration_cast<milliseconds>(cur - base_time).count();
             trend_start = time;
             hedge_all();
         }
         
         if (prev_unhedged <= 10 && prev_unhedged >= -10 && (unhedged > 10 || unhedged < -10)) {
-            auto cur = steady_clock::now();
+            auto cur = timers.Now();
             long time = duration_cast<milliseconds>(cur - base_time).count();
             unhedged_start = time;
         }
         
-        /*wait_event_space();                                           // Wait for another event space
-        SendHedgeOrder(mNextMessageId++, Side::SELL, MIN_BID_NEARST_TICK, volume);
-        insert_event();*/
+        //scheduler.Hedge(Side::SELL, volume);
     }
 
     // Ask Order Fill
-    else if (Asks2Amount.find(clientOrderId) != Asks2Amount.end()) {
+    else if (order != nullptr) {
         if (position <= 0 || (position - volume > 0)) {
             position_price = (position_price * position - volume * price) / (position - volume);
         } else {
             position_price = price;
         }
         
-        position -= (long)volume;                                    // Current position update
-        tend_to_sell -= volume;                                      // To be sold amount update
-        unsigned long remain = Asks2Amount[clientOrderId] - volume;
-        Asks2Amount.erase(clientOrderId);
-        Asks2Amount[clientOrderId] = remain;
+        ledger.OnFill(Side::SELL, volume);                           // Position and to be sold amount update
+        order->mRemainingVolume -= volume;
         
         /*if (unhedged == 0) {
             unhedged -= (long)volume;
@@ -732,24 +659,24 @@ void AutoTrader::OrderFilledMessageHandler(unsigned long clientOrderId,
         unhedged -= (long)volume;
         
         if (prev_unhedged >= 0 && unhedged <= 0) {
-            auto cur = steady_clock::now();
+            auto cur = timers.Now();
             long time = duration_cast<milliseconds>(cur - base_time).count();
             trend_start = time;
             hedge_all();
         }
         
         if (prev_unhedged <= 10 && prev_unhedged >= -10 && (unhedged > 10 || unhedged < -10)) {
-            auto cur = steady_clock::now();
+            auto cur = timers.Now();
             long time = duration_cast<milliseconds>(cur - base_time).count();
             unhedged_start = time;
         }
         
-        /*wait_event_space();                                          // Wait for another event space
-        SendHedgeOrder(mNextMessageId++, Side::BUY, MAX_ASK_NEAREST_TICK, volume);
-        insert_event();*/
+        //scheduler.Hedge(Side::BUY, volume);
     }
     
-    RLOG(LG_AT, LogLevel::LL_INFO) << "Current Position is " << position << " to buy " << tend_to_own << " to sell " << tend_to_sell;
+    ledger.Verify(orders);
+    RLOG(LG_AT, LogLevel::LL_INFO) << "Current Position is " << ledger.Position() << " to buy "
+                                   << ledger.PendingVolume(Side::BUY) << " to sell " << ledger.PendingVolume(Side::SELL);
 }
 
 void AutoTrader::OrderStatusMessageHandler(unsigned long clientOrderId,
@@ -759,21 +686,12 @@ void AutoTrader::OrderStatusMessageHandler(unsigned long clientOrderId,
 {
     // Delete fully filled orders
     if (remainingVolume == 0) {
-        ongoing_order_num -= 1;
-
-        if (deleted.find(clientOrderId) != deleted.end()) {
-            deleted.erase(clientOrderId);
-        }
-        
-        if (Bids2Price.find(clientOrderId) != Bids2Price.end()) {
-            Bids2Price.erase(clientOrderId);
-            Bids2Amount.erase(clientOrderId);
-            Bids2Seq.erase(clientOrderId);
-        } else {
-            Asks2Price.erase(clientOrderId);
-            Asks2Amount.erase(clientOrderId);
-            Asks2Seq.erase(clientOrderId);
+        if (const OrderTable::Order* order = orders.Find(clientOrderId)) {
+            ledger.OnDone(order->mSide, order->mRemainingVolume);
+            orders.Remove(clientOrderId);
         }
+        scheduler.DropCancel(clientOrderId);
+        ledger.Verify(orders);
     }
 }
 
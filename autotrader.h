@@ -21,9 +21,8 @@
 #include <array>
 #include <memory>
 #include <string>
-#include <unordered_set>
+#include <string_view>
 #include <tuple>
-#include <unordered_map>
 #include <vector>
 #include <chrono>
 #include <map>
@@ -31,18 +30,32 @@
 #include <boost/asio/io_context.hpp>
 
 #include <ready_trader_go/baseautotrader.h>
+#include <ready_trader_go/ratelimiter.h>
+#include <ready_trader_go/timersource.h>
 #include <ready_trader_go/types.h>
 
+#include "actionscheduler.h"
+#include "exposureledger.h"
+#include "ordertable.h"
+#include "pairedbooks.h"
+
 using namespace std::chrono;
 
-class AutoTrader : public ReadyTraderGo::BaseAutoTrader
+class AutoTrader : public ReadyTraderGo::BaseAutoTraderT<AutoTrader>
 {
 public:
-    explicit AutoTrader(boost::asio::io_context& context);
+    // Time, for the message limit and the strategy's own timing, is taken
+    // from timers.
+    AutoTrader(boost::asio::io_context& context, ReadyTraderGo::ITimerSource& timers);
     
-    void insert_event();
-    void wait_event_space();
-    void clear_event();
+    void cancel_order(OrderTable::Order& order);
+
+    // Called by the scheduler as it sends each action.
+    void execute_hedge(ReadyTraderGo::Side side, unsigned long volume);
+    void execute_cancel(unsigned long client_order_id);
+    void execute_quote(const PendingQuote& quote);
+    bool can_add_order();
+    bool can_queue_quote(ReadyTraderGo::Side side);
     unsigned long weighted_average(const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& volume, const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& price);
     bool trader_can_buy(unsigned long count, unsigned long price_to_buy);
     bool trader_can_sell(unsigned long count, unsigned long price_to_sell);
@@ -52,13 +65,16 @@ public:
     void hedge_partial(bool trend);
     
     // Called when the execution connection is lost.
-    void DisconnectHandler() override;
+    void DisconnectHandler();
 
     // Called when the matching engine detects an error.
     // If the error pertains to a particular order, then the client_order_id
     // will identify that order, otherwise the client_order_id will be zero.
+    // The error code identifies the kind of error; the message points into
+    // the receive buffer and is only valid during the call.
     void ErrorMessageHandler(unsigned long clientOrderId,
-                             const std::string& errorMessage) override;
+                             ReadyTraderGo::ErrorCode errorCode,
+                             std::string_view errorMessage);
 
     // Called when one of your hedge orders is filled, partially or fully.
     //
@@ -69,7 +85,7 @@ public:
     // If the order was unsuccessful, both the price and volume will be zero.
     void HedgeFilledMessageHandler(unsigned long clientOrderId,
                                    unsigned long price,
-                                   unsigned long volume) override;
+                                   unsigned long volume);
 
     // Called periodically to report the status of an order book.
     // The sequence number can be used to detect missed or out-of-order
@@ -81,12 +97,12 @@ public:
                                  const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
                                  const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
                                  const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
-                                 const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes) override;
+                                 const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes);
 
     // Called when one of your orders is filled, partially or fully.
     void OrderFilledMessageHandler(unsigned long clientOrderId,
                                    unsigned long price,
-                                   unsigned long volume) override;
+                                   unsigned long volume);
 
     // Called when the status of one of your orders changes.
     // The fill volume is the number of lots already traded, remaining volume
@@ -96,7 +112,7 @@ public:
     void OrderStatusMessageHandler(unsigned long clientOrderId,
                                    unsigned long fillVolume,
                                    unsigned long remainingVolume,
-                                   signed long fees) override;
+                                   signed long fees);
 
     // Called periodically when there is trading activity on the market.
     // The five best ask (i.e. sell) and bid (i.e. buy) prices at which there
@@ -109,41 +125,27 @@ public:
                                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
                                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
                                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
-                                  const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes) override;
+                                  const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes);
 
 private:
 
     unsigned long mNextMessageId = 1;
-    signed long position = 0;
-    
-    // Store the ongoing orders
-    std::unordered_map<unsigned long, unsigned long> Asks2Seq;
-    std::unordered_map<unsigned long, unsigned long> Asks2Amount;
-    std::unordered_map<unsigned long, unsigned long> Asks2Price;
-    std::unordered_map<unsigned long, unsigned long> Bids2Seq;
-    std::unordered_map<unsigned long, unsigned long> Bids2Amount;
-    std::unordered_map<unsigned long, unsigned long> Bids2Price;
+    ReadyTraderGo::ITimerSource& timers;
     
-    // Store the deleted orders for wash order
-    std::unordered_set<unsigned long> deleted;
+    // Store the ongoing orders, including those cancelled as wash orders
+    OrderTable orders;
     
     // Store the order books for matching Future and ETF
-    std::unordered_map<unsigned long, unsigned long> OB2Mid;
-    std::unordered_map<unsigned long, unsigned long> OB2BestBidPrice;
-    std::unordered_map<unsigned long, unsigned long> OB2BestBidVol;
-    std::unordered_map<unsigned long, unsigned long> OB2BestAskPrice;
-    std::unordered_map<unsigned long, unsigned long> OB2BestAskVol;
+    PairedBooks books;
+
+    // Position, volume still to trade on each side and active order count,
+    // kept in step with the order table
+    ExposureLedger ledger;
                                              
-    // Store the recent activity time
-    std::vector<long long> recent_activity;
-    
     // Store the recent future mid price
     std::vector<unsigned long> recent_future;
     
     unsigned long last_seq = 0;
-    unsigned long ongoing_order_num = 0;
-    unsigned long tend_to_own = 0;
-    unsigned long tend_to_sell = 0;
     unsigned long history_limit = 4;
     unsigned long position_price = 0;
     int future_sell_price = 0;
@@ -152,7 +154,13 @@ private:
     unsigned long future_avg_size = 3;
     long long bound_time = 1050;
     unsigned long message_limit = 48;
+    unsigned long active_order_limit = 10;
     unsigned long order_message_count = 3;
+    
+    // Keep messages within the limit per second without blocking the loop,
+    // spending the budget on hedges first, then cancels, then new orders
+    ReadyTraderGo::RateLimiter limiter;
+    ActionScheduler<AutoTrader> scheduler;
     unsigned long last_future = 0;
     unsigned long avg_count = 0;
     int fail_limit = 2;
@@ -160,8 +168,8 @@ private:
     long unhedged_start = -1;
     long trend_start = 0;
     int hedge_fail = 0;
-    steady_clock::time_point base_time = steady_clock::now();
-    steady_clock::time_point last_trade = steady_clock::now();
+    steady_clock::time_point base_time = timers.Now();
+    steady_clock::time_point last_trade = timers.Now();
 };
 
 #endif //CPPREADY_TRADER_GO_AUTOTRADER_H
@@ -0,0 +1,82 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_EXPOSURELEDGER_H
+#define CPPREADY_TRADER_GO_EXPOSURELEDGER_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+#include <ready_trader_go/types.h>
+
+#include "ordertable.h"
+
+// The trader's ETF position and the volume its active orders could still
+// add to it on each side. Every insert, fill and completed order updates it
+// in place, so reading it never needs a scan of the orders.
+class ExposureLedger
+{
+public:
+    long Position() const { return mPosition; }
+    unsigned long PendingVolume(ReadyTraderGo::Side side) const { return mPending[static_cast<std::size_t>(side)]; }
+    std::size_t ActiveOrderCount() const { return mActiveOrderCount; }
+
+    void OnInsert(ReadyTraderGo::Side side, unsigned long volume);
+    void OnFill(ReadyTraderGo::Side side, unsigned long volume);
+
+    // An order is done, whether filled, cancelled or expired, with the
+    // given volume never traded.
+    void OnDone(ReadyTraderGo::Side side, unsigned long remainingVolume);
+
+    // In debug builds, check the ledger against a full recompute from the
+    // order table.
+    void Verify(const OrderTable& orders) const;
+
+private:
+    long mPosition = 0;
+    std::array<unsigned long, 2> mPending = {};
+    std::size_t mActiveOrderCount = 0;
+};
+
+inline void ExposureLedger::OnInsert(ReadyTraderGo::Side side, unsigned long volume)
+{
+    mPending[static_cast<std::size_t>(side)] += volume;
+    ++mActiveOrderCount;
+}
+
+inline void ExposureLedger::OnFill(ReadyTraderGo::Side side, unsigned long volume)
+{
+    mPending[static_cast<std::size_t>(side)] -= volume;
+    mPosition += (side == ReadyTraderGo::Side::BUY) ? (long)volume : -(long)volume;
+}
+
+inline void ExposureLedger::OnDone(ReadyTraderGo::Side side, unsigned long remainingVolume)
+{
+    mPending[static_cast<std::size_t>(side)] -= remainingVolume;
+    --mActiveOrderCount;
+}
+
+inline void ExposureLedger::Verify(const OrderTable& orders) const
+{
+    assert(PendingVolume(ReadyTraderGo::Side::BUY) == orders.RemainingVolume(ReadyTraderGo::Side::BUY));
+    assert(PendingVolume(ReadyTraderGo::Side::SELL) == orders.RemainingVolume(ReadyTraderGo::Side::SELL));
+    assert(ActiveOrderCount() == orders.Size());
+    (void)orders;
+}
+
+#endif //CPPREADY_TRADER_GO_EXPOSURELEDGER_H
@@ -19,8 +19,15 @@
 #include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
 #include <string>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
 #define BOOST_BIND_GLOBAL_PLACEHOLDERS
 #include <boost/log/attributes/clock.hpp>
 #include <boost/log/core.hpp>
@@ -86,6 +93,12 @@ void Application::LoadConfig(const std::string& filename)
         throw ReadyTraderGoError("failed while reading configuration file: '" + filename + "': " + err.message());
     }
 
+    mPerformance.readFromPropertyTree(tree);
+    if (mPerformance.mCpu < -1)
+        throw ReadyTraderGoError("configured CPU must be -1 or a CPU number");
+    if (mPerformance.mSchedFifoPriority < 0 || mPerformance.mSchedFifoPriority > 99)
+        throw ReadyTraderGoError("configured SCHED_FIFO priority must be between 0 and 99");
+
     OnConfigLoaded(tree);
 }
 
@@ -114,9 +127,85 @@ void Application::Run(int argc, char* argv[])
     mSignals.async_wait([this](const boost::system::error_code& ec, int s) { SignalHandler(ec, s); });
 
     OnReadyToRun();
+
+    // Any threads started by OnReadyToRun keep their own CPU and scheduling
+    // policy.
+    ApplyPerformanceConfig();
     mContext.run();
 }
 
+void Application::ApplyPerformanceConfig()
+{
+#ifdef __linux__
+    bool isMemoryLocked = false;
+    if (mPerformance.mLockMemory)
+    {
+        isMemoryLocked = ::mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+        if (!isMemoryLocked)
+        {
+            RLOG(LG_APP, LogLevel::LL_WARNING) << "failed to lock memory: " << std::strerror(errno);
+        }
+    }
+
+    if (mPerformance.mCpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(mPerformance.mCpu, &cpus);
+        const int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (result != 0)
+        {
+            RLOG(LG_APP, LogLevel::LL_WARNING) << "failed to pin the event loop to CPU " << mPerformance.mCpu
+                                               << ": " << std::strerror(result);
+        }
+    }
+
+    if (mPerformance.mSchedFifoPriority > 0)
+    {
+        sched_param param = {};
+        param.sched_priority = mPerformance.mSchedFifoPriority;
+        const int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (result != 0)
+        {
+            RLOG(LG_APP, LogLevel::LL_WARNING) << "failed to set SCHED_FIFO priority "
+                                               << mPerformance.mSchedFifoPriority << ": " << std::strerror(result);
+        }
+    }
+
+    // Report what the event loop actually got, whatever was asked for.
+    std::ostringstream cpuList;
+    cpu_set_t cpus;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0)
+    {
+        const char* separator = "";
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &cpus))
+            {
+                cpuList << separator << cpu;
+                separator = ",";
+            }
+        }
+    }
+
+    int policy = 0;
+    sched_param param = {};
+    pthread_getschedparam(pthread_self(), &policy, &param);
+
+    RLOG(LG_APP, LogLevel::LL_INFO) << "event loop running on cpus=" << cpuList.str() << " with policy="
+                                    << (policy == SCHED_FIFO ? "SCHED_FIFO" : policy == SCHED_RR ? "SCHED_RR"
+                                                                                                 : "SCHED_OTHER")
+                                    << " priority=" << param.sched_priority << " memory_locked=" << std::boolalpha
+                                    << isMemoryLocked;
+#else
+    if (mPerformance.mCpu >= 0 || mPerformance.mSchedFifoPriority > 0 || mPerformance.mLockMemory)
+    {
+        RLOG(LG_APP, LogLevel::LL_WARNING) << "CPU affinity, SCHED_FIFO and mlockall are not supported on this"
+                                              " platform";
+    }
+#endif
+}
+
 void Application::SetUpLogging()
 {
     std::string logFilename = mName + ".log";
@@ -33,6 +33,8 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/system/error_code.hpp>
 
+#include "config.h"
+
 namespace ReadyTraderGo {
 
 constexpr std::size_t LOG_QUEUE_SIZE = 1024;
@@ -60,6 +62,7 @@ private:
     void OnConfigLoaded(const boost::property_tree::ptree& tree) const;
     void OnReadyToRun() const;
 
+    void ApplyPerformanceConfig();
     void LoadConfig(const std::string& filename);
     void SetUpLogging();
     void SignalHandler(const boost::system::error_code& error, int signal);
@@ -68,6 +71,7 @@ private:
     boost::asio::io_context mContext;
     std::string mName;
     boost::asio::signal_set mSignals;
+    PerformanceConfig mPerformance;
 
     using sink_t = boost::log::sinks::asynchronous_sink<
         boost::log::sinks::text_ostream_backend,
@@ -37,12 +37,45 @@ void AutoTraderAppHandler::ConfigLoadedHandler(const boost::property_tree::ptree
     if (config.mSecret.size() > MessageFieldSize::STRING)
         throw ReadyTraderGoError("configured secret is too long");
 
+    if (config.mInfoBatchSize == 0)
+        throw ReadyTraderGoError("configured information batch size must be at least one");
+
+    if (config.mExecPollMode != "reactor" && config.mExecPollMode != "busy")
+        throw ReadyTraderGoError("configured execution poll mode must be 'reactor' or 'busy'");
+
+    if (config.mPerformance.mBusyPollMicroseconds < 0)
+        throw ReadyTraderGoError("configured busy poll microseconds must not be negative");
+
+    if (config.mPerformance.mReceiveBufferSize < 0 || config.mPerformance.mSendBufferSize < 0)
+        throw ReadyTraderGoError("configured socket buffer sizes must not be negative");
+
+    if (config.mExecTransport != "asio" && config.mExecTransport != "io_uring")
+        throw ReadyTraderGoError("configured execution transport must be 'asio' or 'io_uring'");
+
+    ConnectionOptions connectionOptions;
+    connectionOptions.mBusyPoll = config.mExecPollMode == "busy";
+    connectionOptions.mBusyPollMicroseconds = config.mPerformance.mBusyPollMicroseconds;
+    connectionOptions.mQuickAck = config.mPerformance.mQuickAck;
+    connectionOptions.mReceiveBufferSize = config.mPerformance.mReceiveBufferSize;
+    connectionOptions.mSendBufferSize = config.mPerformance.mSendBufferSize;
+    connectionOptions.mIoUring = config.mExecTransport == "io_uring";
+    connectionOptions.mIoUringSqPoll = config.mExecSqPoll;
     mExecConnectionFactory = std::make_unique<ConnectionFactory>(mContext,
                                                                  config.mExecHost,
-                                                                 config.mExecPort);
+                                                                 config.mExecPort,
+                                                                 connectionOptions);
+    SubscriptionOptions subscriptionOptions;
+    subscriptionOptions.mPollThread = config.mInfoPollThread;
+    subscriptionOptions.mPollThreadCpu = config.mInfoPollThreadCpu;
+    subscriptionOptions.mBatchSize = config.mInfoBatchSize;
+    subscriptionOptions.mBufferSize = config.mInfoBufferSize;
+    subscriptionOptions.mFrameSize = config.mInfoFrameSize;
+    subscriptionOptions.mJournalFile = config.mInfoJournal;
+    subscriptionOptions.mJournalSize = config.mInfoJournalSize;
     mInfoSubscriptionFactory = std::make_unique<SubscriptionFactory>(mContext,
                                                                      config.mInfoType,
-                                                                     config.mInfoName);
+                                                                     config.mInfoName,
+                                                                     subscriptionOptions);
 
     mAutoTrader.SetLoginDetails(config.mTeamName, config.mSecret);
 }
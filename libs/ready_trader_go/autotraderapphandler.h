@@ -31,7 +31,7 @@ namespace ReadyTraderGo {
 class AutoTraderAppHandler
 {
 public:
-    explicit AutoTraderAppHandler(Application& application, BaseAutoTrader& autoTrader)
+    explicit AutoTraderAppHandler(Application& application, IAutoTrader& autoTrader)
         : mApplication(application), mAutoTrader(autoTrader), mContext(mApplication.GetContext())
     {
         mApplication.ConfigLoaded = [this](auto& tree) { ConfigLoadedHandler(tree); };
@@ -43,7 +43,7 @@ private:
     void ReadyToRunHandler();
 
     Application& mApplication;
-    BaseAutoTrader& mAutoTrader;
+    IAutoTrader& mAutoTrader;
     boost::asio::io_context& mContext;
 
     std::unique_ptr<ConnectionFactory> mExecConnectionFactory;
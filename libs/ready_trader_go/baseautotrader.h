@@ -22,21 +22,131 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <boost/asio/io_context.hpp>
 
 #include "connectivitytypes.h"
+#include "error.h"
+#include "latencytracker.h"
+#include "logging.h"
 #include "protocol.h"
 #include "types.h"
 
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_BAT, "BASE")
+
 namespace ReadyTraderGo {
 
-class BaseAutoTrader
+// The part of an auto-trader the application needs to wire it up to the
+// exchange, independent of how the trader dispatches its messages.
+class IAutoTrader
+{
+public:
+    virtual ~IAutoTrader() = default;
+
+    virtual void SetExecutionConnection(std::unique_ptr<IConnection>&& connection) = 0;
+    virtual void SetInformationSubscription(std::shared_ptr<ISubscription>&& subscription) = 0;
+    virtual void SetLoginDetails(std::string teamName, std::string secret) = 0;
+};
+
+// Auto-trader base that dispatches to the callbacks of Derived statically,
+// so the decoding of each message can be inlined into the strategy.
+//
+// Derived hides whichever of the callbacks below it wants to handle; the
+// rest default to doing nothing. A Derived that declares its callbacks
+// protected or private must befriend BaseAutoTraderT<Derived>.
+template<typename Derived>
+class BaseAutoTraderT : public IAutoTrader
+{
+public:
+    explicit BaseAutoTraderT(boost::asio::io_context& context);
+    ~BaseAutoTraderT() override;
+
+    // Messages sent between BeginBatch and the matching Flush are written to
+    // the execution connection together. Every message handler is already
+    // wrapped in a batch.
+    void BeginBatch();
+    void Flush();
+
+    void SendAmendOrder(unsigned long clientOrderId, unsigned long volume);
+    void SendCancelOrder(unsigned long clientOrderId);
+    void SendHedgeOrder(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume);
+    void SendInsertOrder(unsigned long clientOrderId,
+                         Side side,
+                         unsigned long price,
+                         unsigned long volume,
+                         Lifespan lifespan);
+
+    // Hedge orders for the given side sent at this price only need their
+    // id and volume written.
+    void SetHedgePrice(Side side, unsigned long price);
+
+    void SetExecutionConnection(std::unique_ptr<IConnection>&& connection) override;
+    void SetInformationSubscription(std::shared_ptr<ISubscription>&& subscription) override;
+    void SetLoginDetails(std::string teamName, std::string secret) override;
+
+protected:
+    boost::asio::io_context& mContext;
+    std::unique_ptr<IConnection> mExecutionConnection = nullptr;
+    std::shared_ptr<ISubscription> mInformationSubscription = nullptr;
+
+    std::string mTeamName;
+    std::string mSecret;
+
+    // Round-trip times of execution requests, reported on destruction.
+    LatencyTracker mLatencyTracker;
+
+    void DisconnectHandler();
+    void MessageHandler(IConnection*, unsigned char, unsigned char const*, std::size_t);
+    void MessageHandler(ISubscription* subscription,
+                        unsigned char messageType,
+                        unsigned char const* data,
+                        std::size_t size);
+
+    // Message callbacks
+    void ErrorMessageHandler(unsigned long clientOrderId, ErrorCode errorCode, std::string_view errorMessage) {};
+    void HedgeFilledMessageHandler(unsigned long clientOrderId, unsigned long price, unsigned long volume) {};
+    void OrderBookMessageHandler(Instrument instrument,
+                                 unsigned long sequenceNumber,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) {};
+    void OrderFilledMessageHandler(unsigned long clientOrderId, unsigned long price, unsigned long volume) {};
+    void OrderStatusMessageHandler(unsigned long clientOrderId,
+                                   unsigned long fillVolume,
+                                   unsigned long remainingVolume,
+                                   signed long fees) {};
+    void TradeTicksMessageHandler(Instrument instrument,
+                                  unsigned long sequenceNumber,
+                                  const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                                  const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                                  const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                                  const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) {};
+
+private:
+    Derived& Self() { return static_cast<Derived&>(*this); }
+
+    // Order messages encoded ahead of time, by side and then lifespan, so
+    // that each send only patches the fields that change.
+    std::array<std::array<MessageTemplate<InsertMessage>, 2>, 2> mInsertTemplates;
+    std::array<MessageTemplate<HedgeMessage>, 2> mHedgeTemplates;
+    std::array<unsigned long, 2> mHedgePrices = {};
+    MessageTemplate<AmendMessage> mAmendTemplate;
+    MessageTemplate<CancelMessage> mCancelTemplate;
+};
+
+// Auto-trader base with virtual callbacks, for strategies that prefer
+// overriding to the static dispatch of BaseAutoTraderT.
+class BaseAutoTrader : public BaseAutoTraderT<BaseAutoTrader>
 {
+    friend class BaseAutoTraderT<BaseAutoTrader>;
+
 public:
-    explicit BaseAutoTrader(boost::asio::io_context& context) : mContext(context) {};
+    explicit BaseAutoTrader(boost::asio::io_context& context) : BaseAutoTraderT(context) {};
+    ~BaseAutoTrader() override;
 
     virtual void SendAmendOrder(unsigned long clientOrderId, unsigned long volume);
     virtual void SendCancelOrder(unsigned long clientOrderId);
@@ -50,18 +160,7 @@ public:
                                  unsigned long volume,
                                  Lifespan lifespan);
 
-    virtual void SetExecutionConnection(std::unique_ptr<IConnection>&& connection);
-    virtual void SetInformationSubscription(std::shared_ptr<ISubscription>&& subscription);
-    virtual void SetLoginDetails(std::string teamName, std::string secret);
-
 protected:
-    boost::asio::io_context& mContext;
-    std::unique_ptr<IConnection> mExecutionConnection = nullptr;
-    std::shared_ptr<ISubscription> mInformationSubscription = nullptr;
-
-    std::string mTeamName;
-    std::string mSecret;
-
     virtual void DisconnectHandler();
     virtual void MessageHandler(IConnection*, unsigned char, unsigned char const*, std::size_t);
     virtual void MessageHandler(ISubscription* subscription,
@@ -70,6 +169,11 @@ protected:
                                 std::size_t size);
 
     // Message callbacks
+    // By default, copies the error message into a string for the overload
+    // below; override this one instead to avoid that allocation.
+    virtual void ErrorMessageHandler(unsigned long clientOrderId,
+                                     ErrorCode errorCode,
+                                     std::string_view errorMessage);
     virtual void ErrorMessageHandler(unsigned long clientOrderId,
                                      const std::string& errorMessage) {};
     virtual void HedgeFilledMessageHandler(unsigned long clientOrderId,
@@ -96,64 +200,229 @@ protected:
                                           const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) {};
 };
 
-inline void BaseAutoTrader::DisconnectHandler()
+template<typename Derived>
+BaseAutoTraderT<Derived>::BaseAutoTraderT(boost::asio::io_context& context) : mContext(context)
+{
+    for (auto side : {Side::SELL, Side::BUY})
+    {
+        for (auto lifespan : {Lifespan::FILL_AND_KILL, Lifespan::GOOD_FOR_DAY})
+        {
+            mInsertTemplates[static_cast<std::size_t>(side)][static_cast<std::size_t>(lifespan)].Reset(
+                InsertMessage{0, side, 0, 0, lifespan});
+        }
+        mHedgeTemplates[static_cast<std::size_t>(side)].Reset(HedgeMessage{0, side, 0, 0});
+    }
+}
+
+template<typename Derived>
+BaseAutoTraderT<Derived>::~BaseAutoTraderT()
+{
+    for (std::size_t i = 0; i < REQUEST_TYPE_COUNT; ++i)
+    {
+        RLOG(LG_BAT, LogLevel::LL_INFO) << REQUEST_TYPE_NAMES[i] << " round-trip latency: "
+                                        << mLatencyTracker.GetHistogram(static_cast<RequestType>(i));
+    }
+    RLOG(LG_BAT, LogLevel::LL_INFO) << mLatencyTracker.GetUnansweredCount() << " requests were never answered";
+}
+
+template<typename Derived>
+void BaseAutoTraderT<Derived>::DisconnectHandler()
 {
     mContext.stop();
 }
 
-inline void BaseAutoTrader::SetInformationSubscription(std::shared_ptr<ISubscription>&& subscription)
+template<typename Derived>
+void BaseAutoTraderT<Derived>::SetExecutionConnection(std::unique_ptr<IConnection>&& connection)
+{
+    mExecutionConnection = std::move(connection);
+    mExecutionConnection->SetName("Exec");
+    mExecutionConnection->Disconnected = [this] { Self().DisconnectHandler(); };
+    mExecutionConnection->MessageReceived = [this](IConnection* c,
+                                                   unsigned char t,
+                                                   unsigned char const* d,
+                                                   std::size_t s) {
+        BeginBatch();
+        Self().MessageHandler(c, t, d, s);
+        Flush();
+    };
+
+    RLOG(LG_BAT, LogLevel::LL_INFO) << "logging in with teamname='" << mTeamName
+                                    << "' and secret='" << mSecret << '\'';
+    mExecutionConnection->SendMessage(LoginMessage{mTeamName, mSecret});
+
+    mExecutionConnection->AsyncRead();
+}
+
+template<typename Derived>
+void BaseAutoTraderT<Derived>::SetInformationSubscription(std::shared_ptr<ISubscription>&& subscription)
 {
     mInformationSubscription = std::move(subscription);
     mInformationSubscription->SetName("Info");
     mInformationSubscription->MessageReceived = [this](ISubscription* s,
                                                        unsigned char t,
                                                        unsigned char const* d,
-                                                       std::size_t z) { MessageHandler(s, t, d, z); };
+                                                       std::size_t z) {
+        BeginBatch();
+        Self().MessageHandler(s, t, d, z);
+        Flush();
+    };
     mInformationSubscription->AsyncReceive();
 }
 
-inline void BaseAutoTrader::SendAmendOrder(unsigned long clientOrderId, unsigned long volume)
+template<typename Derived>
+void BaseAutoTraderT<Derived>::SetLoginDetails(std::string teamName, std::string secret)
 {
-    mExecutionConnection->SendMessage(MessageType::AMEND_ORDER,
-                                      AmendMessage{clientOrderId, volume});
+    mTeamName = std::move(teamName);
+    mSecret = std::move(secret);
 }
 
-inline void BaseAutoTrader::SendCancelOrder(unsigned long clientOrderId)
+template<typename Derived>
+void BaseAutoTraderT<Derived>::MessageHandler(IConnection* connection,
+                                              unsigned char messageType,
+                                              unsigned char const* data,
+                                              std::size_t size)
 {
-    mExecutionConnection->SendMessage(MessageType::CANCEL_ORDER,
-                                      CancelMessage{clientOrderId});
+    const auto now = LatencyTracker::Clock::now();
+
+    switch (messageType)
+    {
+    case MessageType::ERROR_MESSAGE:
+    {
+        const ErrorMessageView err{data};
+        if (err.GetClientOrderId() != 0)
+            mLatencyTracker.OnResponse(err.GetClientOrderId(), now);
+        Self().ErrorMessageHandler(err.GetClientOrderId(), err.GetCode(), err.GetMessage());
+        break;
+    }
+    case MessageType::HEDGE_FILLED:
+    {
+        const HedgeFilledMessageView filled{data};
+        mLatencyTracker.OnResponse(filled.GetClientOrderId(), now);
+        Self().HedgeFilledMessageHandler(filled.GetClientOrderId(), filled.GetPrice(), filled.GetVolume());
+        break;
+    }
+    case MessageType::ORDER_FILLED:
+    {
+        const OrderFilledMessageView filled{data};
+        mLatencyTracker.OnResponse(filled.GetClientOrderId(), now);
+        Self().OrderFilledMessageHandler(filled.GetClientOrderId(), filled.GetPrice(), filled.GetVolume());
+        break;
+    }
+    case MessageType::ORDER_STATUS:
+    {
+        const OrderStatusMessageView status{data};
+        mLatencyTracker.OnResponse(status.GetClientOrderId(), now);
+        Self().OrderStatusMessageHandler(status.GetClientOrderId(), status.GetFillVolume(),
+                                         status.GetRemainingVolume(), status.GetFees());
+        break;
+    }
+    default:
+    {
+        RLOG(LG_BAT, LogLevel::LL_ERROR) << "received execution message with unexpected type: "
+                                         << static_cast<int>(messageType);
+        throw ReadyTraderGoError("received execution message with unexpected type");
+    }
+    }
 }
 
-inline void BaseAutoTrader::SendHedgeOrder(unsigned long clientOrderId,
-                                           Side side,
-                                           unsigned long price,
-                                           unsigned long volume)
+template<typename Derived>
+void BaseAutoTraderT<Derived>::MessageHandler(ISubscription* subscription,
+                                              unsigned char messageType,
+                                              unsigned char const* data,
+                                              std::size_t size)
 {
-    mExecutionConnection->SendMessage(MessageType::HEDGE_ORDER,
-                                      HedgeMessage{clientOrderId,
-                                                   side,
-                                                   price,
-                                                   volume});
+    switch (messageType)
+    {
+    case MessageType::ORDER_BOOK_UPDATE:
+    {
+        auto book = makeMessage<OrderBookMessage>(data, size);
+        Self().OrderBookMessageHandler(book.mInstrument, book.mSequenceNumber, book.mAskPrices,
+                                       book.mAskVolumes, book.mBidPrices, book.mBidVolumes);
+        break;
+    }
+    case MessageType::TRADE_TICKS:
+    {
+        auto ticks = makeMessage<TradeTicksMessage>(data, size);
+        Self().TradeTicksMessageHandler(ticks.mInstrument, ticks.mSequenceNumber, ticks.mAskPrices,
+                                        ticks.mAskVolumes, ticks.mBidPrices, ticks.mBidVolumes);
+        break;
+    }
+    default:
+    {
+        RLOG(LG_BAT, LogLevel::LL_ERROR) << "received information message with unexpected type: "
+                                         << static_cast<int>(messageType);
+        throw ReadyTraderGoError("received information message with unexpected type");
+    }
+    }
 }
 
-inline void BaseAutoTrader::SendInsertOrder(unsigned long clientOrderId,
-                                            Side side,
-                                            unsigned long price,
-                                            unsigned long volume,
-                                            Lifespan lifespan)
+template<typename Derived>
+void BaseAutoTraderT<Derived>::BeginBatch()
 {
-    mExecutionConnection->SendMessage(MessageType::INSERT_ORDER,
-                                      InsertMessage{clientOrderId,
-                                                    side,
-                                                    price,
-                                                    volume,
-                                                    lifespan});
+    if (mExecutionConnection)
+        mExecutionConnection->BeginBatch();
 }
 
-inline void BaseAutoTrader::SetLoginDetails(std::string teamName, std::string secret)
+template<typename Derived>
+void BaseAutoTraderT<Derived>::Flush()
 {
-    mTeamName = std::move(teamName);
-    mSecret = std::move(secret);
+    if (mExecutionConnection)
+        mExecutionConnection->Flush();
+}
+
+template<typename Derived>
+void BaseAutoTraderT<Derived>::SendAmendOrder(unsigned long clientOrderId, unsigned long volume)
+{
+    mLatencyTracker.OnRequest(RequestType::AMEND, clientOrderId);
+    mAmendTemplate.Send<&AmendMessage::mClientOrderId, &AmendMessage::mNewVolume>(
+        *mExecutionConnection, SendMode::ASAP, clientOrderId, volume);
+}
+
+template<typename Derived>
+void BaseAutoTraderT<Derived>::SendCancelOrder(unsigned long clientOrderId)
+{
+    mLatencyTracker.OnRequest(RequestType::CANCEL, clientOrderId);
+    mCancelTemplate.Send<&CancelMessage::mClientOrderId>(*mExecutionConnection, SendMode::ASAP, clientOrderId);
+}
+
+template<typename Derived>
+void BaseAutoTraderT<Derived>::SendHedgeOrder(unsigned long clientOrderId,
+                                              Side side,
+                                              unsigned long price,
+                                              unsigned long volume)
+{
+    mLatencyTracker.OnRequest(RequestType::HEDGE, clientOrderId);
+    const auto& hedge = mHedgeTemplates[static_cast<std::size_t>(side)];
+    if (price == mHedgePrices[static_cast<std::size_t>(side)])
+    {
+        hedge.Send<&HedgeMessage::mClientOrderId, &HedgeMessage::mVolume>(
+            *mExecutionConnection, SendMode::ASAP, clientOrderId, volume);
+    }
+    else
+    {
+        hedge.Send<&HedgeMessage::mClientOrderId, &HedgeMessage::mPrice, &HedgeMessage::mVolume>(
+            *mExecutionConnection, SendMode::ASAP, clientOrderId, price, volume);
+    }
+}
+
+template<typename Derived>
+void BaseAutoTraderT<Derived>::SendInsertOrder(unsigned long clientOrderId,
+                                               Side side,
+                                               unsigned long price,
+                                               unsigned long volume,
+                                               Lifespan lifespan)
+{
+    mLatencyTracker.OnRequest(RequestType::INSERT, clientOrderId);
+    mInsertTemplates[static_cast<std::size_t>(side)][static_cast<std::size_t>(lifespan)]
+        .Send<&InsertMessage::mClientOrderId, &InsertMessage::mPrice, &InsertMessage::mVolume>(
+            *mExecutionConnection, SendMode::ASAP, clientOrderId, price, volume);
+}
+
+template<typename Derived>
+void BaseAutoTraderT<Derived>::SetHedgePrice(Side side, unsigned long price)
+{
+    mHedgePrices[static_cast<std::size_t>(side)] = price;
+    mHedgeTemplates[static_cast<std::size_t>(side)].template Set<&HedgeMessage::mPrice>(price);
 }
 
 }
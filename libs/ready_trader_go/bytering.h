@@ -0,0 +1,129 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BYTERING_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BYTERING_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include <boost/asio/buffer.hpp>
+
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// A fixed-size ring of bytes for use with scatter/gather I/O, in one of two
+// ways: messages are written one at a time (Prepare and Commit) and read as
+// at most two contiguous blocks (Data and Consume), or bytes are received
+// into at most two contiguous blocks (PrepareReceive and CommitReceive) and
+// read a message at a time (Peek and Consume).
+//
+// So that a message can always be accessed in one piece, the storage runs
+// MaximumMessageSize bytes past the end of the ring. Commit copies any part
+// of a written message that landed there back to the start of the ring, and
+// Peek copies the start of the ring there when a message wraps around. Only
+// the part of the message that wraps is ever copied.
+template<std::size_t Capacity, std::size_t MaximumMessageSize>
+class ByteRing
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+    static_assert(MaximumMessageSize <= Capacity, "messages must fit in the ring");
+
+public:
+    ByteRing() = default;
+
+    ByteRing(const ByteRing&) = delete;
+    void operator=(const ByteRing&) = delete;
+
+    // Return somewhere to write a message of the given size, or nullptr if
+    // the message is too large or the ring is too full.
+    unsigned char* Prepare(std::size_t size) noexcept
+    {
+        if (size > MaximumMessageSize || Size() + size > Capacity)
+            return nullptr;
+        return mData + (mTail & (Capacity - 1));
+    }
+
+    // Append the message written to the area returned by Prepare.
+    void Commit(std::size_t size) noexcept
+    {
+        const std::size_t pos = mTail & (Capacity - 1);
+        if (pos + size > Capacity)
+            std::memcpy(mData, mData + Capacity, pos + size - Capacity);
+        mTail += size;
+        mHighWaterMark = std::max(mHighWaterMark, Size());
+    }
+
+    // The unconsumed bytes, oldest first.
+    std::array<boost::asio::const_buffer, 2> Data() const noexcept
+    {
+        const std::size_t pos = mHead & (Capacity - 1);
+        const std::size_t size = Size();
+        const std::size_t first = std::min(size, Capacity - pos);
+        return {boost::asio::const_buffer(mData + pos, first), boost::asio::const_buffer(mData, size - first)};
+    }
+
+    // The free space, in order, to receive bytes into.
+    std::array<boost::asio::mutable_buffer, 2> PrepareReceive() noexcept
+    {
+        const std::size_t pos = mTail & (Capacity - 1);
+        const std::size_t space = Capacity - Size();
+        const std::size_t first = std::min(space, Capacity - pos);
+        return {boost::asio::mutable_buffer(mData + pos, first), boost::asio::mutable_buffer(mData, space - first)};
+    }
+
+    // Append bytes received into the space returned by PrepareReceive.
+    void CommitReceive(std::size_t size) noexcept
+    {
+        mTail += size;
+        mHighWaterMark = std::max(mHighWaterMark, Size());
+    }
+
+    // Return the next size bytes in one piece. The size must be no more
+    // than Size() and MaximumMessageSize.
+    unsigned char const* Peek(std::size_t size) noexcept
+    {
+        const std::size_t pos = mHead & (Capacity - 1);
+        if (pos + size > Capacity)
+            std::memcpy(mData + Capacity, mData, pos + size - Capacity);
+        return mData + pos;
+    }
+
+    void Consume(std::size_t size) noexcept { mHead += size; }
+
+    std::size_t Size() const noexcept { return mTail - mHead; }
+    bool Empty() const noexcept { return mTail == mHead; }
+
+    // All of the ring's storage, e.g. for registering it with the kernel.
+    boost::asio::const_buffer Storage() const noexcept { return {mData, sizeof(mData)}; }
+
+    // The most bytes the ring has held at once.
+    std::size_t GetHighWaterMark() const noexcept { return mHighWaterMark; }
+
+private:
+    std::size_t mHead = 0;
+    std::size_t mTail = 0;
+    std::size_t mHighWaterMark = 0;
+    alignas(CACHE_LINE_SIZE) unsigned char mData[Capacity + MaximumMessageSize];
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BYTERING_H
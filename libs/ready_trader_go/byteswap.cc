@@ -0,0 +1,115 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <climits>
+
+#include "byteswap.h"
+
+// The vector decoders widen each value to 64 bits, so they're only used
+// where unsigned long is that size. Each is compiled for its own instruction
+// set, whatever the rest of the library is compiled for, and only called if
+// the CPU supports it.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) \
+    && ULONG_MAX == 0xffffffffffffffffUL
+#include <immintrin.h>
+#define RTG_VECTOR_BIG_ENDIAN_DECODER 1
+#endif
+
+namespace ReadyTraderGo {
+
+#ifdef RTG_VECTOR_BIG_ENDIAN_DECODER
+// Decode four values, byte swapping all of them with one shuffle, and widen
+// them with two unpacks.
+__attribute__((target("ssse3")))
+static inline void decodeFourBigEndianSsse3(unsigned char const* data, unsigned long* values) noexcept
+{
+    const __m128i swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m128i swapped = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data)), swap);
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values), _mm_unpacklo_epi32(swapped, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values + 2), _mm_unpackhi_epi32(swapped, zero));
+}
+
+// As above, but widen all four with one vpmovzxdq and store them at once.
+__attribute__((target("avx2")))
+static inline void decodeFourBigEndianAvx2(unsigned char const* data, unsigned long* values) noexcept
+{
+    const __m128i swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m128i swapped = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data)), swap);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(values), _mm256_cvtepu32_epi64(swapped));
+}
+
+// Any remainder is picked up by decoding the last four again, which is
+// cheaper than decoding the stragglers one at a time.
+__attribute__((target("ssse3")))
+static void decodeBigEndianSsse3(unsigned char const* data, unsigned long* values, std::size_t count) noexcept
+{
+    if (count < 4)
+    {
+        decodeBigEndianScalar(data, values, count);
+        return;
+    }
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        decodeFourBigEndianSsse3(data + i * 4, values + i);
+    if (i != count)
+        decodeFourBigEndianSsse3(data + (count - 4) * 4, values + count - 4);
+}
+
+__attribute__((target("avx2")))
+static void decodeBigEndianAvx2(unsigned char const* data, unsigned long* values, std::size_t count) noexcept
+{
+    if (count < 4)
+    {
+        decodeBigEndianScalar(data, values, count);
+        return;
+    }
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        decodeFourBigEndianAvx2(data + i * 4, values + i);
+    if (i != count)
+        decodeFourBigEndianAvx2(data + (count - 4) * 4, values + count - 4);
+}
+#endif
+
+std::vector<BigEndianDecoder> supportedBigEndianDecoders()
+{
+    std::vector<BigEndianDecoder> decoders{{"scalar", decodeBigEndianScalar}};
+#ifdef RTG_VECTOR_BIG_ENDIAN_DECODER
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3"))
+        decoders.push_back({"ssse3", decodeBigEndianSsse3});
+    if (__builtin_cpu_supports("avx2"))
+        decoders.push_back({"avx2", decodeBigEndianAvx2});
+#endif
+    return decoders;
+}
+
+// Constant initialised, so anything decoded before the choice is made
+// (during static initialisation) uses the scalar decoder.
+BigEndianDecoder activeBigEndianDecoder = {"scalar", decodeBigEndianScalar};
+
+namespace {
+struct BigEndianDecoderSelector
+{
+    BigEndianDecoderSelector() { activeBigEndianDecoder = supportedBigEndianDecoders().back(); }
+} bigEndianDecoderSelector;
+}
+
+}
@@ -0,0 +1,60 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BYTESWAP_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BYTESWAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/endian/conversion.hpp>
+
+namespace ReadyTraderGo {
+
+using BigEndianDecodeFunction = void (*)(unsigned char const* data, unsigned long* values, std::size_t count) noexcept;
+
+// One way of decoding consecutive four-byte, big endian, unsigned integers.
+struct BigEndianDecoder
+{
+    char const* mName;
+    BigEndianDecodeFunction mDecode;
+};
+
+// Decode count consecutive four-byte, big endian, unsigned integers.
+inline void decodeBigEndianScalar(unsigned char const* data, unsigned long* values, std::size_t count) noexcept
+{
+    for (std::size_t i = 0; i < count; ++i)
+        values[i] = boost::endian::load_big_u32(data + i * 4);
+}
+
+// The decoders this CPU can run, the scalar decoder first and the fastest
+// last. The SSSE3 and AVX2 decoders are always built (on x86 with GCC or
+// Clang), so the same binary runs on any CPU.
+std::vector<BigEndianDecoder> supportedBigEndianDecoders();
+
+// The fastest of the supported decoders, chosen when the program starts.
+extern BigEndianDecoder activeBigEndianDecoder;
+
+inline void decodeBigEndian(unsigned char const* data, unsigned long* values, std::size_t count) noexcept
+{
+    activeBigEndianDecoder.mDecode(data, values, count);
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BYTESWAP_H
@@ -18,34 +18,90 @@
 #ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONFIG_H
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONFIG_H
 
+#include <cstddef>
 #include <string>
 
 #include <boost/property_tree/ptree.hpp>
 
+#include "framereader.h"
+#include "journal.h"
+
 namespace ReadyTraderGo {
 
+// Settings that trade resources for latency. Zero or -1 leaves the operating
+// system's default in place.
+struct PerformanceConfig
+{
+    void readFromPropertyTree(const boost::property_tree::ptree& tree)
+    {
+        mReceiveBufferSize = tree.get<int>("Performance.ReceiveBufferSize", 0);
+        mSendBufferSize = tree.get<int>("Performance.SendBufferSize", 0);
+        mQuickAck = tree.get<bool>("Performance.QuickAck", false);
+        mBusyPollMicroseconds = tree.get<int>("Performance.BusyPollMicroseconds", 0);
+        mCpu = tree.get<int>("Performance.Cpu", -1);
+        mSchedFifoPriority = tree.get<int>("Performance.SchedFifoPriority", 0);
+        mLockMemory = tree.get<bool>("Performance.LockMemory", false);
+    }
+
+    // Socket settings, applied by the connection factory.
+    int mReceiveBufferSize = 0;
+    int mSendBufferSize = 0;
+    bool mQuickAck = false;
+    int mBusyPollMicroseconds = 0;
+
+    // Process settings, applied by the application just before it starts
+    // running the event loop.
+    int mCpu = -1;
+    int mSchedFifoPriority = 0;
+    bool mLockMemory = false;
+};
+
 struct Config
 {
     void readFromPropertyTree(const boost::property_tree::ptree& tree)
     {
         mExecHost = tree.get<std::string>("Execution.Host");
         mExecPort = tree.get<unsigned short>("Execution.Port");
+        mExecPollMode = tree.get<std::string>("Execution.PollMode", "reactor");
+        mExecTransport = tree.get<std::string>("Execution.Transport", "asio");
+        mExecSqPoll = tree.get<bool>("Execution.SqPoll", false);
 
         mInfoType = tree.get<std::string>("Information.Type");
         mInfoName = tree.get<std::string>("Information.Name");
+        mInfoPollThread = tree.get<bool>("Information.PollThread", false);
+        mInfoPollThreadCpu = tree.get<int>("Information.PollThreadCpu", -1);
+        mInfoBatchSize = tree.get<std::size_t>("Information.BatchSize", 1);
+        mInfoBufferSize = tree.get<std::size_t>("Information.BufferSize", SUBSCRIPTION_TRANSPORT_BUFFER_SIZE);
+        mInfoFrameSize = tree.get<std::size_t>("Information.FrameSize", FRAME_SIZE);
+        mInfoJournal = tree.get<std::string>("Information.Journal", "");
+        mInfoJournalSize = tree.get<std::size_t>("Information.JournalSize", JOURNAL_DEFAULT_SIZE);
 
         mTeamName = tree.get<std::string>("TeamName");
         mSecret = tree.get<std::string>("Secret");
+
+        mPerformance.readFromPropertyTree(tree);
     }
 
     std::string mExecHost;
     unsigned short mExecPort;
+    std::string mExecPollMode;
+    std::string mExecTransport;
+    bool mExecSqPoll = false;
 
     std::string mInfoType;
     std::string mInfoName;
+    bool mInfoPollThread = false;
+    int mInfoPollThreadCpu = -1;
+    std::size_t mInfoBatchSize = 1;
+    std::size_t mInfoBufferSize = SUBSCRIPTION_TRANSPORT_BUFFER_SIZE;
+    std::size_t mInfoFrameSize = FRAME_SIZE;
+    std::string mInfoJournal;
+    std::size_t mInfoJournalSize = JOURNAL_DEFAULT_SIZE;
 
     std::string mTeamName;
     std::string mSecret;
+
+    PerformanceConfig mPerformance;
 };
 
 }
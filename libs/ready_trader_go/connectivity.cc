@@ -15,42 +15,91 @@
 //     You should have received a copy of the GNU Affero General Public
 //     License along with Ready Trader Go.  If not, see
 //     <https://www.gnu.org/licenses/>.
+#include <atomic>
 #include <cstddef>
+#include <cstring>
 #include <iomanip>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#endif
+
 #include <boost/asio/connect.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/error.hpp>
+#include <boost/asio/ip/multicast.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ip/udp.hpp>
 #include <boost/asio/post.hpp>
 #include <boost/endian/conversion.hpp>
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/system/error_code.hpp>
 
+#include "byteswap.h"
 #include "connectivity.h"
 #include "error.h"
 #include "logging.h"
+#include "uringconnection.h"
 
 namespace error = boost::asio::error;
 namespace interprocess = boost::interprocess;
 namespace ip = boost::asio::ip;
 using boost::asio::ip::tcp;
+using boost::asio::ip::udp;
 
 RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_CON, "CON")
 
+// Loggers aren't thread safe, so the market data polling thread has its own.
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_MD, "MD")
+
 namespace ReadyTraderGo {
 
-// Theoretical maximum size of an (IPv4) UDP packet (actual maximum is lower).
-constexpr std::size_t READ_SIZE = 65535;
+// Tell the CPU we are in a spin-wait loop.
+static inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#endif
+}
+
+// Pin the calling thread to the given CPU. Returns false if that isn't
+// possible on this platform.
+static bool pinThisThread(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    return false;
+#endif
+}
 
-Connection::Connection(boost::asio::io_context& context, tcp::socket&& socket)
+Connection::Connection(boost::asio::io_context& context,
+                       tcp::socket&& socket,
+                       const ConnectionOptions& options)
     : mContext(context),
-      mInBuffer(),
-      mOutBuffer(),
+      mOptions(options),
+      mInRing(),
       mSocket(std::move(socket))
 {
     SetName('\'' + std::to_string(mSocket.local_endpoint().port()) + '\'');
@@ -58,7 +107,12 @@ Connection::Connection(boost::asio::io_context& context, tcp::socket&& socket)
 
 Connection::~Connection()
 {
-    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing";
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing, outbound ring high-water mark was "
+                                    << mOutRing.GetHighWaterMark() << " of " << EXECUTION_OUTBOUND_RING_SIZE
+                                    << " bytes";
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << ' '
+                                    << (mOptions.mBusyPoll ? "busy poll" : "reactor")
+                                    << " wake-to-handler latency: " << mWakeToHandlerLatency;
     if (mSocket.is_open())
     {
         mSocket.close();
@@ -67,10 +121,90 @@ Connection::~Connection()
 
 void Connection::AsyncRead()
 {
-    auto buf = mInBuffer.prepare(READ_SIZE);
-    mSocket.async_read_some(
-        buf,
-        [this](auto& error, auto size) { ReadSomeHandler(error, size); });
+    if (mOptions.mBusyPoll)
+    {
+        boost::asio::post(mContext, [this]() { Poll(); });
+        return;
+    }
+
+    // Wait for the reactor, then read with the same call as Poll so the
+    // receive timestamp is available in both modes.
+    mSocket.async_wait(tcp::socket::wait_read, [this](const boost::system::error_code& waitError) {
+        boost::system::error_code error = waitError;
+        const std::size_t size = error ? 0 : ReceiveSome(error);
+        if (error == error::would_block)
+            AsyncRead();
+        else
+            ReadSomeHandler(error, size);
+    });
+}
+
+void Connection::Poll()
+{
+    boost::system::error_code error;
+    const std::size_t size = ReceiveSome(error);
+    if (error == error::would_block)
+        boost::asio::post(mContext, [this]() { Poll(); });
+    else
+        ReadSomeHandler(error, size);
+}
+
+std::size_t Connection::ReceiveSome(boost::system::error_code& error)
+{
+    const auto buffers = mInRing.PrepareReceive();
+    iovec iov[2];
+    for (std::size_t i = 0; i < buffers.size(); ++i)
+    {
+        iov[i].iov_base = buffers[i].data();
+        iov[i].iov_len = buffers[i].size();
+    }
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(timespec))];
+    msghdr msg = {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = (iov[1].iov_len > 0) ? 2 : 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    const ssize_t result = ::recvmsg(mSocket.native_handle(), &msg, MSG_DONTWAIT);
+    if (result < 0)
+    {
+        error = boost::system::error_code(errno, boost::asio::error::get_system_category());
+        if (error == error::try_again)
+            error = error::would_block;
+        return 0;
+    }
+    if (result == 0)
+    {
+        error = error::eof;
+        return 0;
+    }
+
+#ifdef __linux__
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+        {
+            timespec received;
+            timespec now;
+            std::memcpy(&received, CMSG_DATA(cmsg), sizeof(received));
+            ::clock_gettime(CLOCK_REALTIME, &now);
+            const std::int64_t latency = (now.tv_sec - received.tv_sec) * 1000000000LL
+                                         + (now.tv_nsec - received.tv_nsec);
+            if (latency >= 0)
+                mWakeToHandlerLatency.Record(static_cast<std::uint64_t>(latency));
+        }
+    }
+
+    if (mOptions.mQuickAck)
+    {
+        // Linux clears this option as soon as it has been acted on.
+        const int one = 1;
+        ::setsockopt(mSocket.native_handle(), IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one));
+    }
+#endif
+
+    return static_cast<std::size_t>(result);
 }
 
 void Connection::ReadSomeHandler(const boost::system::error_code& error, std::size_t size)
@@ -99,36 +233,31 @@ void Connection::ReadSomeHandler(const boost::system::error_code& error, std::si
 
     RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " received " << size
                                      << " bytes";
-    mInBuffer.commit(size);
-
-    auto* const begin = (unsigned char const*) mInBuffer.data().data();
-    auto* upto = begin;
-    auto available = size;
-
-    while (available >= MESSAGE_HEADER_SIZE)
-    {
-        const std::size_t messageLength = boost::endian::big_to_native(*(uint16_t*)upto);
-        if (available < messageLength)
-            break;
+    mInRing.CommitReceive(size);
 
-        const unsigned char messageType = upto[MESSAGE_TYPE_OFFSET];
+    std::size_t invalidLength = 0;
+    const bool valid = dispatchMessages(mInRing, [this](unsigned char messageType, unsigned char const* message,
+                                                        std::size_t messageLength) {
         RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'')
                                          << " received message with type=" << static_cast<int>(messageType)
                                          << " and size=" << messageLength;
-        OnMessageReceipt(messageType, upto + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE);
-
-        upto += messageLength;
-        available -= messageLength;
+        OnMessageReceipt(messageType, message + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE);
+    }, invalidLength);
+    if (!valid)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'')
+                                         << " received message with invalid size=" << invalidLength;
+        OnDisconnect();
+        return;
     }
 
-    mInBuffer.consume(upto - begin);
     AsyncRead();
 }
 
 void Connection::Send()
 {
     mIsSending = true;
-    mSocket.async_write_some(mOutBuffer.data(),
+    mSocket.async_write_some(mOutRing.Data(),
                              [this](auto& err, auto sz) { WriteSomeHandler(err, sz); });
 }
 
@@ -151,21 +280,41 @@ void Connection::Send(SendMode mode)
     }
 }
 
-void Connection::SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode)
+unsigned char* Connection::Prepare(std::size_t size)
 {
-    const std::size_t size = MESSAGE_HEADER_SIZE + serialisable.Size();
-    auto buf = mOutBuffer.prepare(size);
-    auto* data = static_cast<unsigned char*>(buf.data());
-    *(uint16_t*)data = boost::endian::native_to_big((uint16_t)size);
-    data[MESSAGE_TYPE_OFFSET] = messageType;
-    serialisable.Serialise(data + MESSAGE_HEADER_SIZE);
-    mOutBuffer.commit(size);
-    if (!mIsSending)
+    unsigned char* data = mOutRing.Prepare(size);
+    if (data == nullptr)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " cannot queue message with size=" << size
+                                         << ", " << mOutRing.Size() << " bytes are waiting to be sent";
+        throw ReadyTraderGoError("outbound message ring overflow");
+    }
+    return data;
+}
+
+void Connection::Commit(std::size_t size, SendMode mode)
+{
+    mOutRing.Commit(size);
+    if (!mIsSending && mBatchDepth == 0)
     {
         Send(mode);
     }
 }
 
+void Connection::BeginBatch()
+{
+    ++mBatchDepth;
+}
+
+void Connection::Flush()
+{
+    if (mBatchDepth > 0 && --mBatchDepth == 0 && !mIsSending && !mOutRing.Empty())
+    {
+        // Everything queued during the batch goes in a single write.
+        Send();
+    }
+}
+
 void Connection::WriteSomeHandler(const boost::system::error_code& error, std::size_t size)
 {
     if (error)
@@ -183,13 +332,13 @@ void Connection::WriteSomeHandler(const boost::system::error_code& error, std::s
     {
         RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " sent "
                                          << size << " bytes";
-        mOutBuffer.consume(size);
+        mOutRing.Consume(size);
     }
 
-    if (mOutBuffer.size() > 0)
+    if (!mOutRing.Empty())
     {
         mSocket.async_write_some(
-            mOutBuffer.data(), [this](auto& err, auto sz) { WriteSomeHandler(err, sz); });
+            mOutRing.Data(), [this](auto& err, auto sz) { WriteSomeHandler(err, sz); });
     }
     else
     {
@@ -197,24 +346,59 @@ void Connection::WriteSomeHandler(const boost::system::error_code& error, std::s
     }
 }
 
-Subscription::Subscription(boost::asio::io_context& context, interprocess::file_mapping& file, interprocess::mapped_region& region)
-    : mContext(context), mFile(std::move(file)), mRegion(std::move(region))
+Subscription::Subscription(boost::asio::io_context& context,
+                           const std::string& name,
+                           interprocess::mapped_region& region,
+                           const SubscriptionOptions& options)
+    : mContext(context),
+      mRegion(std::move(region)),
+      mOptions(options),
+      mReader(static_cast<unsigned char const*>(mRegion.get_address()),
+              mOptions.mBufferSize,
+              mOptions.mFrameSize)
 {
-    SetName(std::string(mFile.get_name()));
+    SetName(name);
+    if (mOptions.mPollThread)
+    {
+        mQueue = std::make_unique<SpscQueue<MarketDataEvent, MARKET_DATA_QUEUE_CAPACITY>>();
+    }
 }
 
 Subscription::~Subscription()
 {
     RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing";
+    if (mPollThread.joinable())
+    {
+        mStopping.store(true, std::memory_order_relaxed);
+        mPollThread.join();
+    }
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " drained " << mFrameCount
+                                    << " frames in " << mBurstCount << " polls, largest burst was "
+                                    << mLargestBurst << " frames";
+    for (auto instrument : {Instrument::FUTURE, Instrument::ETF})
+    {
+        const FrameStatistics& statistics = mReader.GetStatistics(instrument);
+        RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << ' ' << instrument << ": "
+                                        << statistics.mFrames << " frames, " << statistics.mLostFrames
+                                        << " lost, " << statistics.mTornFrames << " torn";
+    }
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " publisher overran the reader "
+                                    << mReader.GetOverrunCount() << " times";
 }
 
 void Subscription::AsyncReceive()
 {
     std::weak_ptr<ISubscription> weak_this = shared_from_this();
-    mContext.post([this, weak_this](){ AsyncReceive(0, weak_this); });
+    if (mOptions.mPollThread)
+    {
+        RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " starting polling thread";
+        mPollThread = std::thread([this, weak_this]() { PollThread(weak_this); });
+        return;
+    }
+    mContext.post([this, weak_this](){ AsyncReceive(weak_this); });
 }
 
-void Subscription::AsyncReceive(unsigned long pos, std::weak_ptr<ISubscription> weak_this)
+void Subscription::AsyncReceive(std::weak_ptr<ISubscription> weak_this)
 {
     if (weak_this.expired())
     {
@@ -222,25 +406,142 @@ void Subscription::AsyncReceive(unsigned long pos, std::weak_ptr<ISubscription>
         return;
     }
 
-    unsigned char* addr = ((unsigned char*)mRegion.get_address()) + pos;
+    const std::size_t drained = DrainFrames(mOptions.mBatchSize, [this](const MarketDataEvent& event) {
+        ReceiveFromHandler(event.mData, event.mSize);
+    });
+    if (drained > 1)
+    {
+        RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " drained " << drained
+                                         << " frames in one poll";
+    }
+
+    mContext.post([this, weak_this](){ AsyncReceive(weak_this); });
+}
+
+template<typename Handler>
+std::size_t Subscription::DrainFrames(std::size_t limit, Handler&& handler)
+{
+    MarketDataEvent event;
+    std::size_t count = 0;
+
+    while (count < limit)
+    {
+        const FrameStatus status = mReader.Read(event);
+        if (status == FrameStatus::EMPTY)
+            break;
+
+        ++count;
+        if (status == FrameStatus::READY)
+        {
+            handler(event);
+        }
+        else if (status == FrameStatus::OVERRUN)
+        {
+            // Only the polling thread logs to LG_MD, see PollThread.
+            if (mOptions.mPollThread)
+                RLOG(LG_MD, LogLevel::LL_WARNING) << "publisher overran the reader, skipping to newest frame";
+            else
+                RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(mName, '\'')
+                                                   << " publisher overran the reader, skipping to newest frame";
+        }
+    }
+
+    if (count != 0)
+    {
+        mFrameCount += count;
+        ++mBurstCount;
+        if (count > mLargestBurst)
+            mLargestBurst = count;
+    }
+
+    return count;
+}
 
-    if (addr[0] != 0)
+void Subscription::PollThread(std::weak_ptr<ISubscription> weak_this)
+{
+    if (mOptions.mPollThreadCpu >= 0)
     {
-        const uint32_t* payload_size_ptr = (uint32_t*)(addr + FRAME_PAYLOAD_SIZE_OFFSET);
-        const std::size_t payloadSize = boost::endian::big_to_native(*payload_size_ptr);
-        ReceiveFromHandler(addr + FRAME_HEADER_SIZE, payloadSize);
-        pos = (pos + FRAME_SIZE) & (SUBSCRIPTION_TRANSPORT_BUFFER_SIZE - 1);
+        if (pinThisThread(mOptions.mPollThreadCpu))
+        {
+            RLOG(LG_MD, LogLevel::LL_INFO) << "polling thread pinned to cpu " << mOptions.mPollThreadCpu;
+        }
+        else
+        {
+            RLOG(LG_MD, LogLevel::LL_WARNING) << "failed to pin polling thread to cpu " << mOptions.mPollThreadCpu;
+        }
     }
 
-    mContext.post([this, pos, weak_this](){ AsyncReceive(pos, weak_this); });
+    // The journal needs the time each frame arrived, not when the strategy
+    // thread gets to it.
+    const bool isJournaling = IsJournaling();
+    bool stopped = false;
+
+    while (!stopped && !mStopping.load(std::memory_order_relaxed))
+    {
+        const std::size_t drained = DrainFrames(mOptions.mBatchSize, [&](MarketDataEvent& event) {
+            if (isJournaling)
+                event.mReceiveTime = journalTimestamp();
+            while (!stopped && !mQueue->TryPush(event))
+            {
+                stopped = mStopping.load(std::memory_order_relaxed);
+                cpuRelax();
+            }
+        });
+
+        if (drained == 0)
+        {
+            cpuRelax();
+            continue;
+        }
+
+        // Only post a drain when the strategy thread doesn't already have one
+        // pending. Pairs with the fence in DrainQueue.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!mIsDrainPosted.exchange(true, std::memory_order_relaxed))
+        {
+            boost::asio::post(mContext, [this, weak_this]() { DrainQueue(weak_this); });
+        }
+    }
 }
 
-void Subscription::ReceiveFromHandler(unsigned char const* data, std::size_t size)
+void Subscription::DrainQueue(const std::weak_ptr<ISubscription>& weak_this)
 {
+    if (weak_this.expired())
+    {
+        // The 'this' object has been deleted out from underneath us!
+        return;
+    }
+
+    mIsDrainPosted.store(false, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    MarketDataEvent event;
+    while (mQueue->TryPop(event))
+    {
+        ReceiveFromHandler(event.mData, event.mSize, event.mReceiveTime);
+    }
+}
+
+void MessageSubscription::ReceiveFromHandler(unsigned char const* data, std::size_t size)
+{
+    ReceiveFromHandler(data, size, mJournal ? journalTimestamp() : 0);
+}
+
+void MessageSubscription::ReceiveFromHandler(unsigned char const* data, std::size_t size, std::uint64_t receiveTime)
+{
+    if (mJournal)
+        mJournal->Append(data, size, receiveTime);
+
     RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " received "
                                      << size << " bytes";
 
-    const std::size_t messageLength = boost::endian::big_to_native(*(uint16_t*)data);
+    if (size < MESSAGE_HEADER_SIZE)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " malformed message with size=" << size;
+        return;
+    }
+
+    const std::size_t messageLength = boost::endian::load_big_u16(data);
     const unsigned char messageType = data[MESSAGE_TYPE_OFFSET];
 
     if (size != messageLength)
@@ -257,10 +558,115 @@ void Subscription::ReceiveFromHandler(unsigned char const* data, std::size_t siz
     OnMessageReceipt(messageType, data + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE);
 }
 
+MulticastSubscription::MulticastSubscription(boost::asio::io_context& context,
+                                             const std::string& name,
+                                             udp::socket&& socket,
+                                             const SubscriptionOptions& options)
+    : mContext(context), mSocket(std::move(socket)), mOptions(options)
+{
+    SetName(name);
+}
+
+MulticastSubscription::~MulticastSubscription()
+{
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing";
+    if (mSocket.is_open())
+    {
+        boost::system::error_code error;
+        mSocket.close(error);
+    }
+}
+
+void MulticastSubscription::AsyncReceive()
+{
+    std::weak_ptr<ISubscription> weak_this = shared_from_this();
+    mSocket.async_receive(boost::asio::buffer(mBuffer), [this, weak_this](auto& error, auto size) {
+        ReceiveHandler(error, size, weak_this);
+    });
+}
+
+void MulticastSubscription::ReceiveHandler(const boost::system::error_code& error,
+                                           std::size_t size,
+                                           const std::weak_ptr<ISubscription>& weak_this)
+{
+    if (weak_this.expired() || error == error::operation_aborted)
+    {
+        return;
+    }
+
+    if (error)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " receive error: " << error.message();
+    }
+    else
+    {
+        ReceiveFromHandler(mBuffer, size);
+
+        // Take whatever else has already arrived without going back to the
+        // reactor, up to the batch size.
+        boost::system::error_code readError;
+        for (std::size_t i = 1; i < mOptions.mBatchSize; ++i)
+        {
+            const std::size_t more = mSocket.receive(boost::asio::buffer(mBuffer), 0, readError);
+            if (readError)
+                break;
+            ReceiveFromHandler(mBuffer, more);
+        }
+    }
+
+    AsyncReceive();
+}
+
+MulticastPublisher::MulticastPublisher(boost::asio::io_context& context, const udp::endpoint& group)
+    : mSocket(context, udp::v4()), mGroup(group)
+{
+    mSocket.set_option(ip::multicast::outbound_interface(ip::address_v4::loopback()));
+    mSocket.set_option(ip::multicast::enable_loopback(true));
+    mSocket.set_option(ip::multicast::hops(0));
+}
+
+void MulticastPublisher::Publish(unsigned char messageType, const ISerialisable& serialisable)
+{
+    const std::size_t size = MESSAGE_HEADER_SIZE + serialisable.Size();
+    if (size > sizeof(mBuffer))
+        throw ReadyTraderGoError("message is too large to publish");
+
+    boost::endian::store_big_u16(mBuffer, static_cast<std::uint16_t>(size));
+    mBuffer[MESSAGE_TYPE_OFFSET] = messageType;
+    serialisable.Serialise(mBuffer + MESSAGE_HEADER_SIZE);
+    mSocket.send_to(boost::asio::buffer(mBuffer, size), mGroup);
+}
+
+udp::endpoint parseMulticastGroup(const std::string& name)
+{
+    const auto colon = name.rfind(':');
+    if (colon == std::string::npos)
+        throw ReadyTraderGoError("multicast group '" + name + "' should be of the form 'address:port'");
+
+    boost::system::error_code error;
+    const auto address = ip::make_address(name.substr(0, colon), error);
+    if (error || !address.is_multicast())
+        throw ReadyTraderGoError("'" + name.substr(0, colon) + "' is not a multicast address");
+
+    unsigned long port = 0;
+    try
+    {
+        port = std::stoul(name.substr(colon + 1));
+    }
+    catch (const std::exception&)
+    {
+    }
+    if (port == 0 || port > 65535)
+        throw ReadyTraderGoError("multicast group '" + name + "' has an invalid port");
+
+    return udp::endpoint{address, static_cast<unsigned short>(port)};
+}
+
 ConnectionFactory::ConnectionFactory(boost::asio::io_context& context,
                                      std::string host,
-                                     unsigned short port)
-    : mContext(context), mHost(std::move(host)), mPort(port)
+                                     unsigned short port,
+                                     const ConnectionOptions& options)
+    : mContext(context), mHost(std::move(host)), mPort(port), mOptions(options)
 {
     boost::system::error_code error;
     tcp::resolver resolver(mContext);
@@ -305,21 +711,202 @@ std::unique_ptr<IConnection> ConnectionFactory::Create()
     // It's not the end of the world if this fails, so any error is ignored.
     sock.set_option(tcp::no_delay(true), error);
 
-    return std::make_unique<Connection>(mContext, std::move(sock));
+    // The kernel may adjust the requested buffer sizes (Linux doubles them
+    // and caps them at net.core.rmem_max and wmem_max), so report what the
+    // socket actually has.
+    if (mOptions.mReceiveBufferSize > 0)
+    {
+        sock.set_option(tcp::socket::receive_buffer_size(mOptions.mReceiveBufferSize), error);
+        if (error)
+        {
+            RLOG(LG_CON, LogLevel::LL_WARNING) << "failed to set receive buffer size to "
+                                               << mOptions.mReceiveBufferSize << ": " << error.message();
+        }
+    }
+    if (mOptions.mSendBufferSize > 0)
+    {
+        sock.set_option(tcp::socket::send_buffer_size(mOptions.mSendBufferSize), error);
+        if (error)
+        {
+            RLOG(LG_CON, LogLevel::LL_WARNING) << "failed to set send buffer size to "
+                                               << mOptions.mSendBufferSize << ": " << error.message();
+        }
+    }
+    tcp::socket::receive_buffer_size receiveBufferSize;
+    tcp::socket::send_buffer_size sendBufferSize;
+    sock.get_option(receiveBufferSize, error);
+    sock.get_option(sendBufferSize, error);
+    RLOG(LG_CON, LogLevel::LL_INFO) << "socket buffer sizes are receive=" << receiveBufferSize.value()
+                                    << " send=" << sendBufferSize.value() << " bytes";
+
+#ifdef __linux__
+    // Used to measure the latency from the kernel receiving data to it
+    // being handled.
+    const int one = 1;
+    if (::setsockopt(sock.native_handle(), SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one)) != 0)
+    {
+        RLOG(LG_CON, LogLevel::LL_WARNING) << "failed to enable receive timestamps: " << std::strerror(errno);
+    }
+
+    if (mOptions.mBusyPollMicroseconds > 0
+        && ::setsockopt(sock.native_handle(), SOL_SOCKET, SO_BUSY_POLL, &mOptions.mBusyPollMicroseconds,
+                        sizeof(mOptions.mBusyPollMicroseconds)) != 0)
+    {
+        RLOG(LG_CON, LogLevel::LL_WARNING) << "failed to set SO_BUSY_POLL to " << mOptions.mBusyPollMicroseconds
+                                           << " microseconds: " << std::strerror(errno);
+    }
+
+    if (mOptions.mIoUring)
+    {
+        try
+        {
+            auto connection = std::make_unique<UringConnection>(mContext, sock, mOptions);
+            RLOG(LG_CON, LogLevel::LL_INFO) << "execution connection will use io_uring and "
+                                            << (mOptions.mBusyPoll ? "busy poll" : "wait on an eventfd")
+                                            << ", sq_poll=" << std::boolalpha << mOptions.mIoUringSqPoll
+                                            << " busy_poll_us=" << mOptions.mBusyPollMicroseconds
+                                            << " quick_ack=" << mOptions.mQuickAck;
+            return connection;
+        }
+        catch (const ReadyTraderGoError& e)
+        {
+            RLOG(LG_CON, LogLevel::LL_WARNING) << "io_uring is unavailable, falling back to asio: " << e.what();
+        }
+    }
+#else
+    if (mOptions.mBusyPollMicroseconds > 0 || mOptions.mQuickAck || mOptions.mIoUring)
+    {
+        RLOG(LG_CON, LogLevel::LL_WARNING)
+            << "SO_BUSY_POLL, TCP_QUICKACK and io_uring are not supported on this platform";
+    }
+#endif
+
+    RLOG(LG_CON, LogLevel::LL_INFO) << "execution connection will use asio and "
+                                    << (mOptions.mBusyPoll ? "busy poll" : "the reactor")
+                                    << ", busy_poll_us=" << mOptions.mBusyPollMicroseconds
+                                    << " quick_ack=" << std::boolalpha << mOptions.mQuickAck;
+
+    return std::make_unique<Connection>(mContext, std::move(sock), mOptions);
+}
+
+static bool isPowerOfTwo(std::size_t n)
+{
+    return n != 0 && (n & (n - 1)) == 0;
 }
 
 SubscriptionFactory::SubscriptionFactory(boost::asio::io_context& context,
                                          const std::string& type,
-                                         const std::string& name)
-    : mContext(context), mType(type), mName(name)
+                                         const std::string& name,
+                                         const SubscriptionOptions& options)
+    : mContext(context), mType(type), mName(name), mOptions(options)
 {
+    if (mType != "mmap" && mType != "shm" && mType != "udp")
+        throw ReadyTraderGoError("information type must be one of 'mmap', 'shm' or 'udp'");
+
+    if (!isPowerOfTwo(mOptions.mBufferSize))
+        throw ReadyTraderGoError("information buffer size must be a power of two");
+
+    if (!isPowerOfTwo(mOptions.mFrameSize) || mOptions.mFrameSize > mOptions.mBufferSize)
+        throw ReadyTraderGoError("information frame size must be a power of two no larger than the buffer size");
+
+    if (mOptions.mFrameSize < FRAME_SIZE)
+        throw ReadyTraderGoError("information frame size must be at least " + std::to_string(FRAME_SIZE));
+}
+
+// Map the information buffer. The region remains valid after the file or
+// shared memory object it was created from is closed.
+static interprocess::mapped_region mapInformationBuffer(const std::string& type, const std::string& name)
+{
+    if (type == "mmap")
+    {
+        interprocess::file_mapping file{name.c_str(), interprocess::read_only};
+        return interprocess::mapped_region{file, interprocess::read_only};
+    }
+
+    if (type == "shm")
+    {
+        interprocess::shared_memory_object shm{interprocess::open_only, name.c_str(), interprocess::read_only};
+        interprocess::mapped_region region{shm, interprocess::read_only};
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        // Let the kernel back the ring with transparent huge pages where
+        // shared memory huge pages are enabled. Failure is harmless.
+        ::madvise(region.get_address(), region.get_size(), MADV_HUGEPAGE);
+#endif
+        return region;
+    }
+
+    throw ReadyTraderGoError("unknown information type '" + type + "'");
 }
 
 std::shared_ptr<ISubscription> SubscriptionFactory::Create()
 {
-    interprocess::file_mapping file{mName.c_str(), interprocess::read_only};
-    interprocess::mapped_region region{file, interprocess::read_only};
-    return std::make_shared<Subscription>(mContext, file, region);
+    auto subscription = (mType == "udp") ? CreateMulticast() : CreateRing();
+    if (!mOptions.mJournalFile.empty())
+        subscription->SetJournal(std::make_unique<JournalWriter>(mOptions.mJournalFile, mOptions.mJournalSize));
+    RLOG(LG_CON, LogLevel::LL_INFO) << "prices and volumes will be decoded by the " << activeBigEndianDecoder.mName
+                                    << " decoder";
+    return subscription;
+}
+
+std::shared_ptr<MessageSubscription> SubscriptionFactory::CreateRing()
+{
+    interprocess::mapped_region region;
+    try
+    {
+        region = mapInformationBuffer(mType, mName);
+    }
+    catch (const interprocess::interprocess_exception& e)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << "failed to map " << mType << ' ' << std::quoted(mName, '\'')
+                                         << ": " << e.what();
+        throw ReadyTraderGoError("failed to map information " + mType + " '" + mName + "': " + e.what());
+    }
+
+    if (region.get_size() < mOptions.mBufferSize)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " is " << region.get_size()
+                                         << " bytes but the configured buffer size is "
+                                         << mOptions.mBufferSize << " bytes";
+        throw ReadyTraderGoError("information buffer '" + mName + "' is smaller than the configured buffer size");
+    }
+
+    RLOG(LG_CON, LogLevel::LL_INFO) << mType << ' ' << std::quoted(mName, '\'') << " mapped " << region.get_size()
+                                    << " bytes, using a buffer of " << mOptions.mBufferSize
+                                    << " bytes with " << mOptions.mFrameSize << " byte frames";
+    return std::make_shared<Subscription>(mContext, mName, region, mOptions);
+}
+
+std::shared_ptr<MessageSubscription> SubscriptionFactory::CreateMulticast()
+{
+    const udp::endpoint group = parseMulticastGroup(mName);
+
+    if (mOptions.mPollThread)
+    {
+        RLOG(LG_CON, LogLevel::LL_WARNING) << "polling thread is not supported for multicast, ignoring";
+    }
+
+    boost::system::error_code error;
+    udp::socket sock(mContext);
+    sock.open(udp::v4(), error);
+    if (!error)
+        sock.set_option(udp::socket::reuse_address(true), error);
+    if (!error)
+        sock.bind(udp::endpoint{ip::address_v4::any(), group.port()}, error);
+    if (!error)
+        sock.set_option(ip::multicast::join_group(group.address().to_v4(), ip::address_v4::loopback()), error);
+    if (!error)
+        sock.non_blocking(true, error);
+
+    if (error)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << "failed to join multicast group " << std::quoted(mName, '\'')
+                                         << ": " << error.message();
+        throw ReadyTraderGoError("failed to join multicast group '" + mName + "': " + error.message());
+    }
+
+    RLOG(LG_CON, LogLevel::LL_INFO) << "joined multicast group " << std::quoted(mName, '\'')
+                                    << " on the loopback interface";
+    return std::make_shared<MulticastSubscription>(mContext, mName, std::move(sock), mOptions);
 }
 
-}
\ No newline at end of file
+}
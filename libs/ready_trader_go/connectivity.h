@@ -18,87 +18,263 @@
 #ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITY_H
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITY_H
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
-#include <boost/asio/streambuf.hpp>
-#include <boost/interprocess/file_mapping.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/endian/conversion.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/system/error_code.hpp>
 
+#include "bytering.h"
 #include "connectivitytypes.h"
+#include "framereader.h"
+#include "journal.h"
+#include "latencytracker.h"
+#include "spscqueue.h"
 
 namespace interprocess = boost::interprocess;
 using boost::asio::ip::tcp;
+using boost::asio::ip::udp;
 
 namespace ReadyTraderGo {
 
-// Each message begins with a two-part header:
-//   1. length - a two-byte, big endian, unsigned integer; and
-//   2. type - a one-byte unsigned integer.
-constexpr std::size_t MESSAGE_HEADER_SIZE = 3;
-constexpr std::size_t MESSAGE_TYPE_OFFSET = 2;
+// The largest message on the execution channel (a login message is 103
+// bytes) must fit in this.
+constexpr std::size_t EXECUTION_MAXIMUM_MESSAGE_SIZE = 128;
 
-// Each subscription transport frame begins with a two-part header:
-//    1. spinlock - a four-byte little-endian flag (either 0 or 1); and
-//    2. payload size - a four-byte, big endian, unsigned intteger.
-constexpr std::size_t FRAME_PAYLOAD_SIZE_OFFSET = 4;
-constexpr std::size_t FRAME_HEADER_SIZE = 8;
-constexpr std::size_t FRAME_SIZE = 128;
-constexpr std::size_t SUBSCRIPTION_TRANSPORT_BUFFER_SIZE = 8182;
+// Incoming execution messages are received into a ring of this many bytes.
+constexpr std::size_t EXECUTION_INBOUND_RING_SIZE = 16384;
 
+// Outgoing execution messages are queued in a ring of this many bytes. The
+// exchange allows 50 messages per second, and an insert order message is 17
+// bytes, so this holds around ten seconds' worth of messages.
+constexpr std::size_t EXECUTION_OUTBOUND_RING_SIZE = 8192;
+
+// Number of market data events that can be handed from the polling thread to
+// the strategy thread before the polling thread has to wait.
+constexpr std::size_t MARKET_DATA_QUEUE_CAPACITY = 1024;
+
+// Pass each complete message at the front of the ring to the handler, as
+// handler(type, message, length) with message pointing at the header, and
+// then consume it. Returns false, with the offending length, if a message
+// cannot be valid.
+template<typename Ring, typename Handler>
+bool dispatchMessages(Ring& ring, Handler&& handler, std::size_t& invalidLength)
+{
+    while (ring.Size() >= MESSAGE_HEADER_SIZE)
+    {
+        const std::size_t messageLength = boost::endian::load_big_u16(ring.Peek(MESSAGE_HEADER_SIZE));
+        if (messageLength < MESSAGE_HEADER_SIZE || messageLength > EXECUTION_MAXIMUM_MESSAGE_SIZE)
+        {
+            invalidLength = messageLength;
+            return false;
+        }
+
+        if (ring.Size() < messageLength)
+            break;
+
+        // Handlers see the message where it was received.
+        unsigned char const* message = ring.Peek(messageLength);
+        handler(message[MESSAGE_TYPE_OFFSET], message, messageLength);
+        ring.Consume(messageLength);
+    }
+    return true;
+}
+
+struct SubscriptionOptions
+{
+    // Spin on the transport from a dedicated thread rather than by posting a
+    // handler to the io_context for every poll.
+    bool mPollThread = false;
+
+    // CPU to which the polling thread is pinned, or -1 for no pinning.
+    int mPollThreadCpu = -1;
+
+    // Maximum number of ready frames consumed by a single poll.
+    std::size_t mBatchSize = 1;
+
+    // Geometry of the ring buffer shared with the publisher.
+    std::size_t mBufferSize = SUBSCRIPTION_TRANSPORT_BUFFER_SIZE;
+    std::size_t mFrameSize = FRAME_SIZE;
+
+    // File to which received messages are recorded, or empty for none.
+    std::string mJournalFile;
+    std::size_t mJournalSize = JOURNAL_DEFAULT_SIZE;
+};
+
+struct ConnectionOptions
+{
+    // Spin on a non-blocking receive from the io_context, alongside any
+    // other polled handlers, rather than waiting for the reactor.
+    bool mBusyPoll = false;
+
+    // Value for the socket's SO_BUSY_POLL option, or zero to leave it unset.
+    int mBusyPollMicroseconds = 0;
+
+    // Values for the socket's SO_RCVBUF and SO_SNDBUF options, or zero to
+    // leave them unset.
+    int mReceiveBufferSize = 0;
+    int mSendBufferSize = 0;
+
+    // Set TCP_QUICKACK after every receive so acknowledgements are not
+    // delayed.
+    bool mQuickAck = false;
+
+    // Use io_uring rather than asio's reactor for the socket, falling back
+    // to asio if the kernel doesn't support the features needed.
+    bool mIoUring = false;
+
+    // Have a kernel thread poll io_uring's submission queue, so messages are
+    // sent without a system call while the connection is busy.
+    bool mIoUringSqPoll = false;
+};
 
 class Connection : public IConnection
 {
 public:
-    Connection(boost::asio::io_context& context, tcp::socket&& socket);
+    Connection(boost::asio::io_context& context,
+               tcp::socket&& socket,
+               const ConnectionOptions& options = ConnectionOptions());
     ~Connection() override;
     void AsyncRead() override;
-    void SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode) override;
+    unsigned char* Prepare(std::size_t size) override;
+    void Commit(std::size_t size, SendMode mode) override;
+    void BeginBatch() override;
+    void Flush() override;
 
 private:
     void Send();
     void Send(SendMode mode);
 
+    void Poll();
+    std::size_t ReceiveSome(boost::system::error_code& error);
     void ReadSomeHandler(const boost::system::error_code& error, std::size_t size);
     void WriteSomeHandler(const boost::system::error_code& error, std::size_t size);
 
     boost::asio::io_context& mContext;
-    boost::asio::streambuf mInBuffer;
-    boost::asio::streambuf mOutBuffer;
+    ConnectionOptions mOptions;
+
+    // Time from the kernel receiving data to it being handled.
+    LatencyHistogram mWakeToHandlerLatency;
+
+    ByteRing<EXECUTION_INBOUND_RING_SIZE, EXECUTION_MAXIMUM_MESSAGE_SIZE> mInRing;
+    ByteRing<EXECUTION_OUTBOUND_RING_SIZE, EXECUTION_MAXIMUM_MESSAGE_SIZE> mOutRing;
     bool mIsSending = false;
     bool mIsSendPosted = false;
+    unsigned int mBatchDepth = 0;
     tcp::socket mSocket;
 };
 
-class Subscription : public ISubscription
+// Base for subscriptions whose transport delivers one message per frame or
+// datagram.
+class MessageSubscription : public ISubscription
+{
+public:
+    void SetJournal(std::unique_ptr<JournalWriter>&& journal) { mJournal = std::move(journal); }
+
+protected:
+    bool IsJournaling() const { return mJournal != nullptr; }
+
+    // Handle a message received just now.
+    void ReceiveFromHandler(unsigned char const* data, std::size_t size);
+
+    // Handle a message received at the given time (see journalTimestamp),
+    // e.g. on another thread.
+    void ReceiveFromHandler(unsigned char const* data, std::size_t size, std::uint64_t receiveTime);
+
+private:
+    std::unique_ptr<JournalWriter> mJournal;
+};
+
+class Subscription : public MessageSubscription
 {
 public:
     Subscription(boost::asio::io_context& context,
-                 interprocess::file_mapping& file,
-                 interprocess::mapped_region& region);
+                 const std::string& name,
+                 interprocess::mapped_region& region,
+                 const SubscriptionOptions& options);
     ~Subscription() override;
     void AsyncReceive() override;
 
 private:
-    void AsyncReceive(unsigned long, std::weak_ptr<ISubscription>);
-    void ReceiveFromHandler(unsigned char const*, std::size_t size);
+    void AsyncReceive(std::weak_ptr<ISubscription>);
+    template<typename Handler>
+    std::size_t DrainFrames(std::size_t limit, Handler&& handler);
+    void DrainQueue(const std::weak_ptr<ISubscription>& weak_this);
+    void PollThread(std::weak_ptr<ISubscription> weak_this);
 
     boost::asio::io_context& mContext;
-    interprocess::file_mapping mFile;
     interprocess::mapped_region mRegion;
+    SubscriptionOptions mOptions;
+    FrameReader mReader;
+
+    // Burst statistics, i.e. how many frames each non-empty poll consumed.
+    std::size_t mFrameCount = 0;
+    std::size_t mBurstCount = 0;
+    std::size_t mLargestBurst = 0;
+
+    // Only used when the transport is polled from a dedicated thread.
+    std::thread mPollThread;
+    std::atomic<bool> mStopping{false};
+    std::atomic<bool> mIsDrainPosted{false};
+    std::unique_ptr<SpscQueue<MarketDataEvent, MARKET_DATA_QUEUE_CAPACITY>> mQueue;
+};
+
+// Receives information messages as UDP multicast datagrams on the loopback
+// interface, which lets any number of processes share one feed.
+class MulticastSubscription : public MessageSubscription
+{
+public:
+    MulticastSubscription(boost::asio::io_context& context,
+                          const std::string& name,
+                          udp::socket&& socket,
+                          const SubscriptionOptions& options);
+    ~MulticastSubscription() override;
+    void AsyncReceive() override;
+
+private:
+    void ReceiveHandler(const boost::system::error_code& error,
+                        std::size_t size,
+                        const std::weak_ptr<ISubscription>& weak_this);
+
+    boost::asio::io_context& mContext;
+    udp::socket mSocket;
+    SubscriptionOptions mOptions;
+    unsigned char mBuffer[FRAME_MAXIMUM_PAYLOAD_SIZE];
 };
 
+// Publishes information messages to a loopback multicast group, standing in
+// for the exchange when testing MulticastSubscription.
+class MulticastPublisher
+{
+public:
+    MulticastPublisher(boost::asio::io_context& context, const udp::endpoint& group);
+
+    void Publish(unsigned char messageType, const ISerialisable& serialisable);
+
+private:
+    udp::socket mSocket;
+    udp::endpoint mGroup;
+    unsigned char mBuffer[FRAME_MAXIMUM_PAYLOAD_SIZE];
+};
+
+// Parse a multicast group of the form "address:port".
+udp::endpoint parseMulticastGroup(const std::string& name);
+
 class ConnectionFactory : public IConnectionFactory
 {
 public:
     ConnectionFactory(boost::asio::io_context& context,
                       std::string host,
-                      unsigned short port);
+                      unsigned short port,
+                      const ConnectionOptions& options = ConnectionOptions());
 
     std::unique_ptr<IConnection> Create() override;
 
@@ -107,6 +283,7 @@ private:
     std::vector<tcp::endpoint> mEndpoints;
     std::string mHost;
     unsigned short mPort;
+    ConnectionOptions mOptions;
 };
 
 class SubscriptionFactory : public ISubscriptionFactory
@@ -114,14 +291,19 @@ class SubscriptionFactory : public ISubscriptionFactory
 public:
     SubscriptionFactory(boost::asio::io_context& context,
                         const std::string& type,
-                        const std::string& name);
+                        const std::string& name,
+                        const SubscriptionOptions& options = SubscriptionOptions());
 
     std::shared_ptr<ISubscription> Create() override;
 
 private:
+    std::shared_ptr<MessageSubscription> CreateMulticast();
+    std::shared_ptr<MessageSubscription> CreateRing();
+
     boost::asio::io_context& mContext;
     std::string mType;
     std::string mName;
+    SubscriptionOptions mOptions;
 };
 
 }
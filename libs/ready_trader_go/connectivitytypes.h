@@ -19,12 +19,22 @@
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITYTYPES_H
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 
+#include <boost/endian/conversion.hpp>
+
 namespace ReadyTraderGo {
 
+// Each message begins with a two-part header:
+//   1. length - a two-byte, big endian, unsigned integer; and
+//   2. type - a one-byte unsigned integer.
+constexpr std::size_t MESSAGE_HEADER_SIZE = 3;
+constexpr std::size_t MESSAGE_TYPE_OFFSET = 2;
+
 enum class SendMode
 {
     ASAP,
@@ -42,14 +52,40 @@ struct IConnection
 {
     virtual ~IConnection() = default;
     virtual void AsyncRead() = 0;
-    virtual void SendMessage(unsigned char messageType,
-                             const ISerialisable& serialisable,
-                             SendMode mode) = 0;
+    // Return somewhere to write a message of the given size, header
+    // included, which Commit then sends. Throws ReadyTraderGoError if the
+    // message can't be queued.
+    virtual unsigned char* Prepare(std::size_t size) = 0;
+    virtual void Commit(std::size_t size, SendMode mode) = 0;
+
+    // Encode a message straight into the connection's outbound buffer using
+    // its compile-time layout (see MessageTraits in protocol.h).
+    template<typename Message>
+    void SendMessage(const Message& message, SendMode mode = SendMode::ASAP);
+
+    // Send any serialisable message, at the cost of virtual calls to encode
+    // it.
+    void SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode)
+    {
+        const std::size_t size = MESSAGE_HEADER_SIZE + serialisable.Size();
+        unsigned char* data = Prepare(size);
+        boost::endian::store_big_u16(data, static_cast<std::uint16_t>(size));
+        data[MESSAGE_TYPE_OFFSET] = messageType;
+        serialisable.Serialise(data + MESSAGE_HEADER_SIZE);
+        Commit(size, mode);
+    }
+
     void SendMessage(unsigned char messageType, const ISerialisable& serialisable)
     {
         SendMessage(messageType, serialisable, SendMode::ASAP);
     }
 
+    // Messages sent between BeginBatch and the matching Flush are held back
+    // and then written together. Batches may be nested, in which case only
+    // the outermost Flush writes.
+    virtual void BeginBatch() = 0;
+    virtual void Flush() = 0;
+
     const std::string& GetName() const { return mName; }
     void SetName(std::string name) { mName = std::move(name); }
 
@@ -0,0 +1,157 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include <boost/endian/conversion.hpp>
+
+#include "connectivity.h"
+#include "framereader.h"
+#include "protocol.h"
+
+namespace ReadyTraderGo {
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t)
+              && std::atomic<std::uint32_t>::is_always_lock_free,
+              "frame spinlocks are read as lock-free 32-bit atomics");
+
+// Offsets within a market data message (i.e. a frame's payload).
+constexpr std::size_t INSTRUMENT_OFFSET = MESSAGE_HEADER_SIZE;
+constexpr std::size_t SEQUENCE_NUMBER_OFFSET = INSTRUMENT_OFFSET + MessageFieldSize::BYTE;
+constexpr std::size_t SEQUENCED_MESSAGE_MINIMUM_SIZE = SEQUENCE_NUMBER_OFFSET + MessageFieldSize::LONG;
+
+static inline std::uint32_t loadSpinlock(unsigned char const* frame, std::memory_order order)
+{
+    return reinterpret_cast<std::atomic<std::uint32_t> const*>(frame)->load(order);
+}
+
+static inline std::uint32_t generationOf(std::uint32_t spinlock)
+{
+    return spinlock >> FRAME_GENERATION_SHIFT;
+}
+
+FrameReader::FrameReader(unsigned char const* base, std::size_t bufferSize, std::size_t frameSize)
+    : mBase(base), mBufferSize(bufferSize), mFrameSize(frameSize)
+{
+}
+
+FrameStatus FrameReader::Read(MarketDataEvent& event)
+{
+    unsigned char const* frame = mBase + mPos;
+    const std::uint32_t spinlock = loadSpinlock(frame, std::memory_order_acquire);
+    if ((spinlock & FRAME_READY_MASK) == 0)
+        return FrameStatus::EMPTY;
+
+    // A frame written on a later lap than the reader's means the publisher
+    // has passed this position and the frames in between are gone.
+    const std::uint32_t generation = generationOf(spinlock);
+    if (mGeneration == 0)
+    {
+        mGeneration = generation;
+    }
+    else if (generation != mGeneration)
+    {
+        ++mOverruns;
+        Resync();
+        return FrameStatus::OVERRUN;
+    }
+
+    const std::size_t payloadSize = boost::endian::load_big_u32(frame + FRAME_PAYLOAD_SIZE_OFFSET);
+    const bool sizeIsValid = payloadSize <= mFrameSize - FRAME_HEADER_SIZE
+                             && payloadSize <= FRAME_MAXIMUM_PAYLOAD_SIZE;
+    if (sizeIsValid)
+    {
+        std::memcpy(event.mData, frame + FRAME_HEADER_SIZE, payloadSize);
+        event.mSize = payloadSize;
+    }
+
+    // If the spinlock changed while the payload was copied, the publisher
+    // has come around the ring and is rewriting (or has rewritten) this frame.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (loadSpinlock(frame, std::memory_order_relaxed) != spinlock)
+    {
+        if (sizeIsValid && event.mSize > INSTRUMENT_OFFSET && event.mData[INSTRUMENT_OFFSET] <= 1)
+            ++mStatistics[event.mData[INSTRUMENT_OFFSET]].mTornFrames;
+        ++mOverruns;
+        Resync();
+        return FrameStatus::OVERRUN;
+    }
+
+    mPos = (mPos + mFrameSize) & (mBufferSize - 1);
+    if (mPos == 0 && mGeneration != 0)
+        mGeneration = (mGeneration % FRAME_GENERATION_LIMIT) + 1;
+
+    if (!sizeIsValid)
+        return FrameStatus::DROPPED;
+
+    return CheckSequence(event);
+}
+
+FrameStatus FrameReader::CheckSequence(const MarketDataEvent& event)
+{
+    if (event.mSize < SEQUENCED_MESSAGE_MINIMUM_SIZE)
+        return FrameStatus::READY;
+
+    const unsigned char messageType = event.mData[MESSAGE_TYPE_OFFSET];
+    const unsigned char instrument = event.mData[INSTRUMENT_OFFSET];
+    if (instrument > 1)
+        return FrameStatus::READY;
+
+    unsigned long* last;
+    if (messageType == MessageType::ORDER_BOOK_UPDATE)
+        last = &mBookSequences[instrument];
+    else if (messageType == MessageType::TRADE_TICKS)
+        last = &mTicksSequences[instrument];
+    else
+        return FrameStatus::READY;
+
+    const unsigned long sequenceNumber = boost::endian::load_big_u32(event.mData + SEQUENCE_NUMBER_OFFSET);
+    FrameStatistics& statistics = mStatistics[instrument];
+
+    // Never go back to an older book or ticks than one already delivered.
+    if (*last != 0 && sequenceNumber <= *last)
+        return FrameStatus::DROPPED;
+
+    // A gap is counted but the frame is still delivered: the exchange skips
+    // sequence numbers itself when it falls behind.
+    if (*last != 0 && sequenceNumber > *last + 1)
+        statistics.mLostFrames += sequenceNumber - *last - 1;
+    *last = sequenceNumber;
+
+    ++statistics.mFrames;
+    return FrameStatus::READY;
+}
+
+// Move to the newest complete frame, i.e. the one preceding the frame the
+// publisher will write next (which is the only frame with a clear spinlock),
+// and take up the generation it was written on.
+void FrameReader::Resync()
+{
+    for (std::size_t pos = 0; pos < mBufferSize; pos += mFrameSize)
+    {
+        if ((loadSpinlock(mBase + pos, std::memory_order_relaxed) & FRAME_READY_MASK) == 0)
+        {
+            mPos = (pos + mBufferSize - mFrameSize) & (mBufferSize - 1);
+            break;
+        }
+    }
+    mGeneration = generationOf(loadSpinlock(mBase + mPos, std::memory_order_relaxed));
+}
+
+}
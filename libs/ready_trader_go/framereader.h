@@ -0,0 +1,129 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FRAMEREADER_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FRAMEREADER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// Each subscription transport frame begins with a two-part header:
+//    1. spinlock - a four-byte little-endian word, whose low byte is a flag
+//       (either 0 or 1) and whose upper three bytes are the generation, i.e.
+//       the lap of the ring the frame was written on (a publisher that does
+//       not number its laps leaves the generation zero); and
+//    2. payload size - a four-byte, big endian, unsigned intteger.
+//
+// The ring buffer and frame sizes are configurable; these are the defaults,
+// which match the publisher's defaults. Both must be powers of two.
+constexpr std::size_t FRAME_PAYLOAD_SIZE_OFFSET = 4;
+constexpr std::uint32_t FRAME_READY_MASK = 0xFF;
+constexpr unsigned FRAME_GENERATION_SHIFT = 8;
+constexpr std::uint32_t FRAME_GENERATION_LIMIT = 0xFFFFFF;
+constexpr std::size_t FRAME_HEADER_SIZE = 8;
+constexpr std::size_t FRAME_SIZE = 128;
+constexpr std::size_t SUBSCRIPTION_TRANSPORT_BUFFER_SIZE = 8192;
+
+// Large enough for the largest message on the information channel.
+constexpr std::size_t FRAME_MAXIMUM_PAYLOAD_SIZE = FRAME_SIZE - FRAME_HEADER_SIZE;
+
+// A copy of a single frame's payload.
+struct MarketDataEvent
+{
+    // When the frame was read, as given by journalTimestamp, if it is to be
+    // journaled once it has been passed to another thread.
+    std::uint64_t mReceiveTime = 0;
+    std::uint32_t mSize = 0;
+    unsigned char mData[FRAME_MAXIMUM_PAYLOAD_SIZE];
+};
+
+struct FrameStatistics
+{
+    // Frames delivered to the caller.
+    unsigned long mFrames = 0;
+
+    // Gaps in the sequence numbers. These include frames skipped after an
+    // overrun, but also ticks the exchange skipped when it fell behind.
+    unsigned long mLostFrames = 0;
+
+    // Frames that were overwritten while they were being copied.
+    unsigned long mTornFrames = 0;
+};
+
+enum class FrameStatus
+{
+    EMPTY,      // No frame is ready.
+    READY,      // A frame was copied into the event.
+    DROPPED,    // A frame was consumed but was not safe to use.
+    OVERRUN     // The publisher lapped the reader, which has resynchronised.
+};
+
+// Reads frames from the ring buffer shared with the publisher.
+//
+// The publisher writes a frame's payload while its spinlock is zero, clears
+// the spinlock of the following frame and then sets the frame's spinlock.
+// Like a sequence lock, the reader copies the payload out and then checks
+// that the spinlock is unchanged, so a frame being rewritten underneath the
+// reader is detected rather than delivered, even if the publisher went all
+// the way around the ring while it was copied. A frame from a later lap than
+// the reader's means the publisher has passed the reader's position; when
+// that happens the reader skips to the newest frame. Sequence numbers are
+// tracked for each instrument so that gaps in them are counted.
+class FrameReader
+{
+public:
+    FrameReader(unsigned char const* base, std::size_t bufferSize, std::size_t frameSize);
+
+    FrameStatus Read(MarketDataEvent& event);
+
+    const FrameStatistics& GetStatistics(Instrument instrument) const
+    {
+        return mStatistics[static_cast<std::size_t>(instrument)];
+    }
+
+    unsigned long GetOverrunCount() const { return mOverruns; }
+
+private:
+    FrameStatus CheckSequence(const MarketDataEvent& event);
+    void Resync();
+
+    unsigned char const* mBase;
+    std::size_t mBufferSize;
+    std::size_t mFrameSize;
+    std::size_t mPos = 0;
+
+    // The generation of the lap the reader is on, or zero if not yet known
+    // or the publisher does not number its laps.
+    std::uint32_t mGeneration = 0;
+
+    unsigned long mOverruns = 0;
+    std::array<FrameStatistics, 2> mStatistics = {};
+
+    // Sequence numbers seen for each instrument, for order book updates and
+    // trade ticks respectively.
+    std::array<unsigned long, 2> mBookSequences = {};
+    std::array<unsigned long, 2> mTicksSequences = {};
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FRAMEREADER_H
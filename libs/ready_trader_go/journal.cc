@@ -0,0 +1,163 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "error.h"
+#include "journal.h"
+#include "logging.h"
+
+namespace interprocess = boost::interprocess;
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_JNL, "JNL")
+
+namespace ReadyTraderGo {
+
+static interprocess::mapped_region createJournalFile(const std::string& filename, std::size_t capacity)
+{
+    if (capacity < JOURNAL_HEADER_SIZE + 2 * JOURNAL_RECORD_HEADER_SIZE)
+        throw ReadyTraderGoError("journal '" + filename + "' is too small");
+
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw ReadyTraderGoError("failed to create journal '" + filename + "'");
+        file.seekp(static_cast<std::streamoff>(capacity - 1));
+        file.put('\0');
+        if (!file)
+            throw ReadyTraderGoError("failed to allocate journal '" + filename + "'");
+    }
+
+    try
+    {
+        interprocess::file_mapping mapping(filename.c_str(), interprocess::read_write);
+        return interprocess::mapped_region(mapping, interprocess::read_write, 0, capacity);
+    }
+    catch (const interprocess::interprocess_exception& e)
+    {
+        throw ReadyTraderGoError("failed to map journal '" + filename + "': " + e.what());
+    }
+}
+
+JournalWriter::JournalWriter(const std::string& filename, std::size_t capacity)
+    : mFilename(filename),
+      mRegion(createJournalFile(filename, capacity)),
+      mBase(static_cast<unsigned char*>(mRegion.get_address())),
+      mCapacity(capacity)
+{
+    std::memcpy(mBase, JOURNAL_MAGIC, JOURNAL_HEADER_SIZE);
+
+    // Fault the pages in now rather than on the first record to land on each.
+    for (std::size_t i = JOURNAL_HEADER_SIZE; i < mCapacity; i += mRegion.get_page_size())
+        mBase[i] = 0;
+
+    RLOG(LG_JNL, LogLevel::LL_INFO) << "recording information messages to " << std::quoted(mFilename, '\'')
+                                    << " (" << mCapacity << " bytes)";
+}
+
+JournalWriter::~JournalWriter()
+{
+    mRegion.flush();
+    RLOG(LG_JNL, LogLevel::LL_INFO) << std::quoted(mFilename, '\'') << " recorded " << mRecordCount
+                                    << " messages in " << mPos << " bytes, discarded " << mDiscardCount
+                                    << " messages and rejected " << mRejectCount << " messages";
+}
+
+void JournalWriter::Append(unsigned char const* data, std::size_t size, std::uint64_t receiveTime)
+{
+    // An empty record would mark the end of the journal.
+    if (size == 0 || size > JOURNAL_MAXIMUM_PAYLOAD_SIZE)
+    {
+        ++mRejectCount;
+        RLOG(LG_JNL, LogLevel::LL_WARNING) << std::quoted(mFilename, '\'') << " rejected a message of "
+                                           << size << " bytes";
+        return;
+    }
+
+    const std::size_t recordSize = journalRecordSize(size);
+
+    // Leave room for an empty record header to terminate the journal.
+    if (mPos + recordSize + JOURNAL_RECORD_HEADER_SIZE > mCapacity)
+    {
+        if (mDiscardCount++ == 0)
+        {
+            RLOG(LG_JNL, LogLevel::LL_WARNING) << std::quoted(mFilename, '\'')
+                                               << " is full, further messages will not be recorded";
+        }
+        return;
+    }
+
+    JournalRecordHeader header;
+    header.mReceiveTime = receiveTime;
+    header.mSize = static_cast<std::uint32_t>(size);
+    header.mPadding = 0;
+
+    std::memcpy(mBase + mPos, &header, JOURNAL_RECORD_HEADER_SIZE);
+    std::memcpy(mBase + mPos + JOURNAL_RECORD_HEADER_SIZE, data, size);
+    mPos += recordSize;
+    ++mRecordCount;
+}
+
+JournalReader::JournalReader(const std::string& filename) : mFilename(filename)
+{
+    try
+    {
+        interprocess::file_mapping mapping(filename.c_str(), interprocess::read_only);
+        mRegion = interprocess::mapped_region(mapping, interprocess::read_only);
+    }
+    catch (const interprocess::interprocess_exception& e)
+    {
+        throw ReadyTraderGoError("failed to map journal '" + filename + "': " + e.what());
+    }
+
+    mBase = static_cast<unsigned char const*>(mRegion.get_address());
+    mSize = mRegion.get_size();
+    if (mSize < JOURNAL_HEADER_SIZE || std::memcmp(mBase, JOURNAL_MAGIC, JOURNAL_HEADER_SIZE) != 0)
+        throw ReadyTraderGoError("'" + filename + "' is not a journal");
+
+    mRegion.advise(interprocess::mapped_region::advice_sequential);
+}
+
+bool JournalReader::Next(JournalRecord& record)
+{
+    if (mPos + JOURNAL_RECORD_HEADER_SIZE > mSize)
+        return false;
+
+    JournalRecordHeader header;
+    std::memcpy(&header, mBase + mPos, JOURNAL_RECORD_HEADER_SIZE);
+    if (header.mSize == 0)
+        return false;
+
+    if (mPos + JOURNAL_RECORD_HEADER_SIZE + header.mSize > mSize)
+    {
+        RLOG(LG_JNL, LogLevel::LL_WARNING) << std::quoted(mFilename, '\'') << " is truncated at offset " << mPos;
+        return false;
+    }
+
+    record.mReceiveTime = header.mReceiveTime;
+    record.mData = mBase + mPos + JOURNAL_RECORD_HEADER_SIZE;
+    record.mSize = header.mSize;
+    mPos += journalRecordSize(header.mSize);
+    return true;
+}
+
+}
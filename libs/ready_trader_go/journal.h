@@ -0,0 +1,131 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_JOURNAL_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_JOURNAL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace ReadyTraderGo {
+
+// A journal is a file that starts with an eight-byte magic number followed
+// by a sequence of records. Each record has a header:
+//    1. receive time - an eight-byte, native endian count of nanoseconds on
+//       the local monotonic (steady) clock; and
+//    2. size - a four-byte, native endian size of the payload;
+// followed by four bytes of padding and the payload itself (the message
+// exactly as it was received, including its message header). Records are
+// padded to a multiple of eight bytes. The file is preallocated and zero
+// filled, so the first record with a size of zero marks the end, which is
+// why empty messages are never recorded.
+constexpr char JOURNAL_MAGIC[8] = {'R', 'T', 'G', 'J', 'R', 'N', 'L', '1'};
+constexpr std::size_t JOURNAL_HEADER_SIZE = sizeof(JOURNAL_MAGIC);
+constexpr std::size_t JOURNAL_RECORD_HEADER_SIZE = 16;
+constexpr std::size_t JOURNAL_RECORD_ALIGNMENT = 8;
+constexpr std::size_t JOURNAL_DEFAULT_SIZE = 64 * 1024 * 1024;
+
+// Messages carry their length in two bytes, so no larger payload is valid.
+constexpr std::size_t JOURNAL_MAXIMUM_PAYLOAD_SIZE = 0xFFFF;
+
+struct JournalRecordHeader
+{
+    std::uint64_t mReceiveTime;
+    std::uint32_t mSize;
+    std::uint32_t mPadding;
+};
+
+static_assert(sizeof(JournalRecordHeader) == JOURNAL_RECORD_HEADER_SIZE, "unexpected journal record header size");
+
+constexpr std::size_t journalRecordSize(std::size_t payloadSize)
+{
+    return (JOURNAL_RECORD_HEADER_SIZE + payloadSize + JOURNAL_RECORD_ALIGNMENT - 1)
+           & ~(JOURNAL_RECORD_ALIGNMENT - 1);
+}
+
+// The current time, as recorded in a journal.
+inline std::uint64_t journalTimestamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Appends received messages to a journal.
+//
+// The file is created at its full size and mapped up front so that
+// appending a record is a copy into memory, without any system calls. Once
+// the file is full further records are discarded. Empty or oversized
+// messages are rejected rather than recorded.
+class JournalWriter
+{
+public:
+    JournalWriter(const std::string& filename, std::size_t capacity);
+    ~JournalWriter();
+
+    // Append a message received at the given time (see journalTimestamp).
+    void Append(unsigned char const* data, std::size_t size, std::uint64_t receiveTime);
+
+    const std::string& GetFilename() const { return mFilename; }
+    unsigned long GetRecordCount() const { return mRecordCount; }
+    unsigned long GetDiscardCount() const { return mDiscardCount; }
+    unsigned long GetRejectCount() const { return mRejectCount; }
+
+private:
+    std::string mFilename;
+    boost::interprocess::mapped_region mRegion;
+    unsigned char* mBase;
+    std::size_t mCapacity;
+    std::size_t mPos = JOURNAL_HEADER_SIZE;
+
+    unsigned long mRecordCount = 0;
+    unsigned long mDiscardCount = 0;
+    unsigned long mRejectCount = 0;
+};
+
+struct JournalRecord
+{
+    std::uint64_t mReceiveTime = 0;
+    unsigned char const* mData = nullptr;
+    std::size_t mSize = 0;
+};
+
+// Reads the records of a journal in the order they were written.
+class JournalReader
+{
+public:
+    explicit JournalReader(const std::string& filename);
+
+    // Returns false once there are no more records.
+    bool Next(JournalRecord& record);
+
+    const std::string& GetFilename() const { return mFilename; }
+
+private:
+    std::string mFilename;
+    boost::interprocess::mapped_region mRegion;
+    unsigned char const* mBase;
+    std::size_t mSize;
+    std::size_t mPos = JOURNAL_HEADER_SIZE;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_JOURNAL_H
@@ -0,0 +1,128 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+
+#include "latencytracker.h"
+
+namespace ReadyTraderGo {
+
+std::size_t LatencyHistogram::BucketIndex(std::uint64_t value) noexcept
+{
+    if (value < SUB_BUCKET_COUNT)
+        return static_cast<std::size_t>(value);
+
+    // For values in [2^n, 2^(n+1)), use the SUB_BUCKET_BITS bits after the
+    // leading one to choose one of SUB_BUCKET_COUNT buckets.
+    const unsigned n = 63 - __builtin_clzll(value);
+    const std::size_t group = n - SUB_BUCKET_BITS + 1;
+    const std::size_t sub = (value >> (n - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+    return group * SUB_BUCKET_COUNT + sub;
+}
+
+std::uint64_t LatencyHistogram::BucketUpperBound(std::size_t index) noexcept
+{
+    if (index < SUB_BUCKET_COUNT)
+        return index;
+
+    const std::size_t group = index / SUB_BUCKET_COUNT;
+    const std::uint64_t sub = index % SUB_BUCKET_COUNT;
+    const unsigned shift = static_cast<unsigned>(group - 1);
+    return ((SUB_BUCKET_COUNT + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(std::uint64_t value) noexcept
+{
+    ++mBuckets[BucketIndex(value)];
+    ++mCount;
+    mTotal += value;
+    mMinimum = std::min(mMinimum, value);
+    mMaximum = std::max(mMaximum, value);
+}
+
+std::uint64_t LatencyHistogram::GetPercentile(double percentile) const noexcept
+{
+    if (mCount == 0)
+        return 0;
+
+    const auto rank = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(mCount)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += mBuckets[i];
+        if (seen >= std::max<std::uint64_t>(rank, 1))
+            return std::min(BucketUpperBound(i), mMaximum);
+    }
+    return mMaximum;
+}
+
+std::ostream& operator<<(std::ostream& strm, const LatencyHistogram& histogram)
+{
+    strm << "count=" << histogram.GetCount();
+    if (histogram.GetCount() > 0)
+    {
+        strm << " min=" << histogram.GetMinimum()
+             << " mean=" << histogram.GetMean()
+             << " p50=" << histogram.GetPercentile(50.0)
+             << " p90=" << histogram.GetPercentile(90.0)
+             << " p99=" << histogram.GetPercentile(99.0)
+             << " p99.9=" << histogram.GetPercentile(99.9)
+             << " max=" << histogram.GetMaximum() << " (ns)";
+    }
+    return strm;
+}
+
+void LatencyTracker::OnRequest(RequestType type, unsigned long clientOrderId, Clock::time_point now) noexcept
+{
+    Slot& slot = mSlots[clientOrderId & (LATENCY_TRACKER_CAPACITY - 1)];
+    if (slot.mClientOrderId != clientOrderId)
+    {
+        mUnansweredCount += std::count(slot.mIsPending.begin(), slot.mIsPending.end(), true);
+        slot.mIsPending.fill(false);
+        slot.mClientOrderId = clientOrderId;
+    }
+
+    const auto index = static_cast<std::size_t>(type);
+    if (slot.mIsPending[index])
+        ++mUnansweredCount;
+    slot.mSent[index] = now;
+    slot.mIsPending[index] = true;
+}
+
+void LatencyTracker::OnResponse(unsigned long clientOrderId, Clock::time_point now) noexcept
+{
+    Slot& slot = mSlots[clientOrderId & (LATENCY_TRACKER_CAPACITY - 1)];
+    if (slot.mClientOrderId != clientOrderId)
+        return;
+
+    std::size_t oldest = REQUEST_TYPE_COUNT;
+    for (std::size_t i = 0; i < REQUEST_TYPE_COUNT; ++i)
+    {
+        if (slot.mIsPending[i] && (oldest == REQUEST_TYPE_COUNT || slot.mSent[i] < slot.mSent[oldest]))
+            oldest = i;
+    }
+
+    if (oldest != REQUEST_TYPE_COUNT)
+    {
+        slot.mIsPending[oldest] = false;
+        mHistograms[oldest].Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                now - slot.mSent[oldest]).count());
+    }
+}
+
+}
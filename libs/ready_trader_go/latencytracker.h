@@ -0,0 +1,116 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LATENCYTRACKER_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LATENCYTRACKER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace ReadyTraderGo {
+
+// A histogram of durations in nanoseconds with logarithmically sized
+// groups of linearly spaced buckets, so that every recorded value is
+// within 1/16th (about 6%) of its bucket's bounds.
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 4;
+    static constexpr std::size_t SUB_BUCKET_COUNT = std::size_t{1} << SUB_BUCKET_BITS;
+    static constexpr std::size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    void Record(std::uint64_t value) noexcept;
+
+    std::uint64_t GetCount() const noexcept { return mCount; }
+    std::uint64_t GetMinimum() const noexcept { return mCount ? mMinimum : 0; }
+    std::uint64_t GetMaximum() const noexcept { return mMaximum; }
+    std::uint64_t GetMean() const noexcept { return mCount ? mTotal / mCount : 0; }
+
+    // The upper bound of the bucket holding the given percentile.
+    std::uint64_t GetPercentile(double percentile) const noexcept;
+
+private:
+    static std::size_t BucketIndex(std::uint64_t value) noexcept;
+    static std::uint64_t BucketUpperBound(std::size_t index) noexcept;
+
+    std::array<std::uint64_t, BUCKET_COUNT> mBuckets = {};
+    std::uint64_t mCount = 0;
+    std::uint64_t mTotal = 0;
+    std::uint64_t mMinimum = UINT64_MAX;
+    std::uint64_t mMaximum = 0;
+};
+
+std::ostream& operator<<(std::ostream& strm, const LatencyHistogram& histogram);
+
+enum class RequestType : unsigned char { INSERT, CANCEL, AMEND, HEDGE };
+
+constexpr std::size_t REQUEST_TYPE_COUNT = 4;
+
+constexpr const char* REQUEST_TYPE_NAMES[] = {
+    "insert",
+    "cancel",
+    "amend",
+    "hedge"
+};
+
+// Number of client order ids that can have requests awaiting a response.
+// The exchange allows 50 messages per second, so this covers a response
+// that takes many seconds to arrive.
+constexpr std::size_t LATENCY_TRACKER_CAPACITY = 1024;
+
+// Measures the time from sending each execution request to receiving the
+// first response to it (an order status, order filled, hedge filled or
+// error message), with a histogram for each type of request.
+//
+// Requests are kept in a fixed table indexed by client order id. The
+// exchange answers each order's requests in the order they were sent, so a
+// response is matched to the oldest request awaiting one for that order.
+class LatencyTracker
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void OnRequest(RequestType type, unsigned long clientOrderId, Clock::time_point now = Clock::now()) noexcept;
+    void OnResponse(unsigned long clientOrderId, Clock::time_point now = Clock::now()) noexcept;
+
+    const LatencyHistogram& GetHistogram(RequestType type) const noexcept
+    {
+        return mHistograms[static_cast<std::size_t>(type)];
+    }
+
+    // Requests never answered before their slot was needed by another order.
+    unsigned long GetUnansweredCount() const noexcept { return mUnansweredCount; }
+
+private:
+    struct Slot
+    {
+        unsigned long mClientOrderId = 0;
+        std::array<Clock::time_point, REQUEST_TYPE_COUNT> mSent = {};
+        std::array<bool, REQUEST_TYPE_COUNT> mIsPending = {};
+    };
+
+    std::array<Slot, LATENCY_TRACKER_CAPACITY> mSlots = {};
+    std::array<LatencyHistogram, REQUEST_TYPE_COUNT> mHistograms = {};
+    unsigned long mUnansweredCount = 0;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LATENCYTRACKER_H
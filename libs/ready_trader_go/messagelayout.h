@@ -0,0 +1,282 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MESSAGELAYOUT_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MESSAGELAYOUT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <boost/endian/conversion.hpp>
+
+#include "byteswap.h"
+
+namespace ReadyTraderGo {
+
+// A string of at most Capacity characters held inline, for the fixed-size
+// string fields of messages, so that building or decoding one never
+// allocates. Longer strings are truncated.
+template<std::size_t Capacity>
+class FixedString
+{
+public:
+    FixedString() = default;
+    FixedString(char const* data, std::size_t size) noexcept : mSize(std::min(size, Capacity))
+    {
+        std::memcpy(mData.data(), data, mSize);
+    }
+    FixedString(std::string_view value) noexcept : FixedString(value.data(), value.size()) {}
+
+    operator std::string_view() const noexcept { return {mData.data(), mSize}; }
+
+    char const* data() const noexcept { return mData.data(); }
+    std::size_t size() const noexcept { return mSize; }
+    bool empty() const noexcept { return mSize == 0; }
+
+private:
+    std::array<char, Capacity> mData = {};
+    std::size_t mSize = 0;
+};
+
+// How each kind of field is represented on the wire. Every encoding has a
+// fixed size, so the offset of every field in a message is known at compile
+// time.
+namespace Wire {
+
+// A one-byte value, such as a Side or an Instrument.
+struct Byte
+{
+    static constexpr std::size_t SIZE = 1;
+
+    template<typename T>
+    static void Encode(unsigned char* buf, T value) noexcept { *buf = static_cast<unsigned char>(value); }
+
+    template<typename T>
+    static T Decode(unsigned char const* data) noexcept { return static_cast<T>(*data); }
+};
+
+// A four-byte, big endian, unsigned integer.
+struct UInt32
+{
+    static constexpr std::size_t SIZE = 4;
+
+    template<typename T>
+    static void Encode(unsigned char* buf, T value) noexcept
+    {
+        boost::endian::store_big_u32(buf, static_cast<std::uint32_t>(value));
+    }
+
+    template<typename T>
+    static T Decode(unsigned char const* data) noexcept { return static_cast<T>(boost::endian::load_big_u32(data)); }
+};
+
+// A four-byte, big endian, signed integer.
+struct Int32
+{
+    static constexpr std::size_t SIZE = 4;
+
+    template<typename T>
+    static void Encode(unsigned char* buf, T value) noexcept
+    {
+        boost::endian::store_big_s32(buf, static_cast<std::int32_t>(value));
+    }
+
+    template<typename T>
+    static T Decode(unsigned char const* data) noexcept { return static_cast<T>(boost::endian::load_big_s32(data)); }
+};
+
+// A string padded with nulls to a fixed size, which is not null terminated
+// if it fills the field.
+template<std::size_t Size>
+struct String
+{
+    static constexpr std::size_t SIZE = Size;
+
+    static void Encode(unsigned char* buf, std::string_view value) noexcept
+    {
+        const std::size_t length = std::min(value.size(), SIZE);
+        std::memcpy(buf, value.data(), length);
+        std::memset(buf + length, 0, SIZE - length);
+    }
+
+    template<typename T>
+    static T Decode(unsigned char const* data)
+    {
+        auto end = static_cast<unsigned char const*>(std::memchr(data, 0, SIZE));
+        return T(reinterpret_cast<char const*>(data), (end != nullptr) ? end - data : SIZE);
+    }
+};
+
+// A fixed number of values with the same encoding.
+template<typename Encoding, std::size_t Count>
+struct Array
+{
+    static constexpr std::size_t SIZE = Encoding::SIZE * Count;
+
+    template<typename T>
+    static void Encode(unsigned char* buf, const std::array<T, Count>& values) noexcept
+    {
+        for (std::size_t i = 0; i < Count; ++i)
+            Encoding::Encode(buf + i * Encoding::SIZE, values[i]);
+    }
+
+    template<typename T>
+    static T Decode(unsigned char const* data) noexcept
+    {
+        T values;
+        if constexpr (std::is_same_v<Encoding, UInt32> && std::is_same_v<typename T::value_type, unsigned long>)
+        {
+            // The prices and volumes in every market data message come
+            // through here.
+            decodeBigEndian(data, values.data(), Count);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < Count; ++i)
+                values[i] = Encoding::template Decode<typename T::value_type>(data + i * Encoding::SIZE);
+        }
+        return values;
+    }
+};
+
+}
+
+template<typename T>
+struct MemberPointerTraits;
+
+template<typename Class, typename Member>
+struct MemberPointerTraits<Member Class::*>
+{
+    using ClassType = Class;
+    using MemberType = Member;
+};
+
+// One field of a message: the member holding it and its encoding.
+template<auto Member, typename Encoding_>
+struct Field
+{
+    using Encoding = Encoding_;
+    using Type = typename MemberPointerTraits<decltype(Member)>::MemberType;
+    static constexpr auto MEMBER = Member;
+
+    template<auto Other>
+    static constexpr bool Is()
+    {
+        if constexpr (std::is_same_v<decltype(Other), decltype(Member)>)
+            return Other == Member;
+        else
+            return false;
+    }
+};
+
+// The fields of a message in the order they appear on the wire. The size
+// and offsets are compile-time constants, so encoding and decoding compile
+// down to a sequence of stores and loads at fixed offsets.
+template<typename... Fields>
+class MessageLayout
+{
+    static constexpr std::array<std::size_t, sizeof...(Fields)> ComputeOffsets()
+    {
+        constexpr std::size_t sizes[] = {Fields::Encoding::SIZE...};
+        std::array<std::size_t, sizeof...(Fields)> offsets = {};
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < sizeof...(Fields); ++i)
+        {
+            offsets[i] = offset;
+            offset += sizes[i];
+        }
+        return offsets;
+    }
+
+    template<auto Member>
+    static constexpr std::size_t IndexOf()
+    {
+        constexpr bool matches[] = {Fields::template Is<Member>()...};
+        for (std::size_t i = 0; i < sizeof...(Fields); ++i)
+        {
+            if (matches[i])
+                return i;
+        }
+        return sizeof...(Fields);
+    }
+
+    template<typename Message, std::size_t... I>
+    static void EncodeFields(const Message& message, unsigned char* buf, std::index_sequence<I...>) noexcept
+    {
+        (Fields::Encoding::Encode(buf + OFFSETS[I], message.*Fields::MEMBER), ...);
+    }
+
+    template<typename Message, std::size_t... I>
+    static void DecodeFields(Message& message, unsigned char const* data, std::index_sequence<I...>)
+    {
+        ((message.*Fields::MEMBER = Fields::Encoding::template Decode<typename Fields::Type>(data + OFFSETS[I])),
+         ...);
+    }
+
+public:
+    static constexpr std::size_t SIZE = (Fields::Encoding::SIZE + ...);
+    static constexpr std::array<std::size_t, sizeof...(Fields)> OFFSETS = ComputeOffsets();
+
+    // The offset of the given member's field.
+    template<auto Member>
+    static constexpr std::size_t OffsetOf()
+    {
+        constexpr std::size_t index = IndexOf<Member>();
+        static_assert(index < sizeof...(Fields), "member is not part of this layout");
+        return OFFSETS[index];
+    }
+
+    template<typename Message>
+    static void Encode(const Message& message, unsigned char* buf) noexcept
+    {
+        EncodeFields(message, buf, std::index_sequence_for<Fields...>());
+    }
+
+    template<typename Message>
+    static void Decode(Message& message, unsigned char const* data)
+    {
+        DecodeFields(message, data, std::index_sequence_for<Fields...>());
+    }
+
+    // Decode a single field straight from the received bytes.
+    template<auto Member>
+    static auto Get(unsigned char const* data)
+    {
+        using FieldType = std::tuple_element_t<IndexOf<Member>(), std::tuple<Fields...>>;
+        return FieldType::Encoding::template Decode<typename FieldType::Type>(data + OffsetOf<Member>());
+    }
+
+    // Encode a single field over an already encoded message.
+    template<auto Member, typename Value>
+    static void Set(unsigned char* buf, const Value& value) noexcept
+    {
+        using FieldType = std::tuple_element_t<IndexOf<Member>(), std::tuple<Fields...>>;
+        FieldType::Encoding::Encode(buf + OffsetOf<Member>(), value);
+    }
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MESSAGELAYOUT_H
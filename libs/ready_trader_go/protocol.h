@@ -20,11 +20,16 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include <boost/endian/conversion.hpp>
+
 #include "connectivitytypes.h"
+#include "messagelayout.h"
 #include "types.h"
 
 namespace ReadyTraderGo {
@@ -51,53 +56,57 @@ enum MessageFieldSize : std::size_t
     STRING = 50
 };
 
-struct AmendMessage : ISerialisable
+// Each message's type and wire layout, specialised below.
+template<typename Message>
+struct MessageTraits;
+
+// Implements ISerialisable, for code that handles messages of any type,
+// using the message's layout.
+template<typename Message>
+struct SerialisableMessage : ISerialisable
+{
+    std::size_t Size() const noexcept override { return MessageTraits<Message>::Layout::SIZE; }
+
+    void Deserialise(unsigned char const* data, std::size_t) override
+    {
+        MessageTraits<Message>::Layout::Decode(static_cast<Message&>(*this), data);
+    }
+
+    void Serialise(unsigned char* buf) const override
+    {
+        MessageTraits<Message>::Layout::Encode(static_cast<const Message&>(*this), buf);
+    }
+};
+
+struct AmendMessage : SerialisableMessage<AmendMessage>
 {
     AmendMessage() = default;
     AmendMessage(unsigned long clientOrderId, unsigned long newVolume)
         : mClientOrderId(clientOrderId), mNewVolume(newVolume) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 2; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     unsigned long mNewVolume = 0;
 };
 
-struct CancelMessage : ISerialisable
+struct CancelMessage : SerialisableMessage<CancelMessage>
 {
     CancelMessage() = default;
     explicit CancelMessage(unsigned long clientOrderId) : mClientOrderId(clientOrderId) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
 };
 
-struct ErrorMessage : ISerialisable
+struct ErrorMessage : SerialisableMessage<ErrorMessage>
 {
     ErrorMessage() = default;
-    ErrorMessage(unsigned long clientOrderId, std::string message)
-        : mClientOrderId(clientOrderId), mMessage(std::move(message)) {}
-
-    std::size_t Size() const noexcept override
-    {
-        return MessageFieldSize::LONG + MessageFieldSize::STRING;
-    }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
+    ErrorMessage(unsigned long clientOrderId, std::string_view message)
+        : mClientOrderId(clientOrderId), mMessage(message) {}
 
     unsigned long mClientOrderId = 0;
-    std::string mMessage;
+    FixedString<MessageFieldSize::STRING> mMessage;
 };
 
-struct HedgeMessage : ISerialisable
+struct HedgeMessage : SerialisableMessage<HedgeMessage>
 {
     HedgeMessage() = default;
     HedgeMessage(unsigned long clientOrderId,
@@ -109,18 +118,13 @@ struct HedgeMessage : ISerialisable
           mPrice(price),
           mVolume(volume) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 3 + MessageFieldSize::BYTE; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     Side mSide = Side::SELL;
     unsigned long mPrice = 0;
     unsigned long mVolume = 0;
 };
 
-struct HedgeFilledMessage : ISerialisable
+struct HedgeFilledMessage : SerialisableMessage<HedgeFilledMessage>
 {
     HedgeFilledMessage() = default;
     HedgeFilledMessage(unsigned long clientOrderId,
@@ -130,17 +134,12 @@ struct HedgeFilledMessage : ISerialisable
           mPrice(price),
           mVolume(volume) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 3; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     unsigned long mPrice = 0;
     unsigned long mVolume = 0;
 };
 
-struct InsertMessage : ISerialisable
+struct InsertMessage : SerialisableMessage<InsertMessage>
 {
     InsertMessage() = default;
     InsertMessage(unsigned long clientOrderId,
@@ -154,11 +153,6 @@ struct InsertMessage : ISerialisable
           mVolume(volume),
           mLifespan(lifespan) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 3 + MessageFieldSize::BYTE * 2; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     Side mSide = Side::SELL;
     unsigned long mPrice = 0;
@@ -166,25 +160,16 @@ struct InsertMessage : ISerialisable
     Lifespan mLifespan = Lifespan::FILL_AND_KILL;
 };
 
-struct LoginMessage : ISerialisable
+struct LoginMessage : SerialisableMessage<LoginMessage>
 {
     LoginMessage() = default;
-    LoginMessage(std::string name, std::string secret)
-        : mName(std::move(name)), mSecret(std::move(secret)) {}
-
-    std::size_t Size() const noexcept override
-    {
-        return MessageFieldSize::STRING * 2;
-    }
+    LoginMessage(std::string_view name, std::string_view secret) : mName(name), mSecret(secret) {}
 
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
-    std::string mName;
-    std::string mSecret;
+    FixedString<MessageFieldSize::STRING> mName;
+    FixedString<MessageFieldSize::STRING> mSecret;
 };
 
-struct OrderBookMessage : ISerialisable
+struct OrderBookMessage : SerialisableMessage<OrderBookMessage>
 {
     OrderBookMessage() = default;
     OrderBookMessage(Instrument instrument,
@@ -200,16 +185,6 @@ struct OrderBookMessage : ISerialisable
           mBidPrices(bidPrices),
           mBidVolumes(bidVolumes) {}
 
-    std::size_t Size() const noexcept override
-    {
-        return MessageFieldSize::BYTE
-            + MessageFieldSize::LONG
-            + MessageFieldSize::LONG * TOP_LEVEL_COUNT * 4;
-    }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     Instrument mInstrument = Instrument::FUTURE;
     unsigned long mSequenceNumber = 0;
     std::array<unsigned long, TOP_LEVEL_COUNT> mAskPrices = {};
@@ -218,7 +193,7 @@ struct OrderBookMessage : ISerialisable
     std::array<unsigned long, TOP_LEVEL_COUNT> mBidVolumes = {};
 };
 
-struct OrderFilledMessage : ISerialisable
+struct OrderFilledMessage : SerialisableMessage<OrderFilledMessage>
 {
     OrderFilledMessage() = default;
     OrderFilledMessage(unsigned long clientOrderId,
@@ -228,17 +203,12 @@ struct OrderFilledMessage : ISerialisable
           mPrice(price),
           mVolume(volume) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 3; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     unsigned long mPrice = 0;
     unsigned long mVolume = 0;
 };
 
-struct OrderStatusMessage : ISerialisable
+struct OrderStatusMessage : SerialisableMessage<OrderStatusMessage>
 {
     OrderStatusMessage() = default;
     OrderStatusMessage(unsigned long clientOrderId,
@@ -250,18 +220,13 @@ struct OrderStatusMessage : ISerialisable
           mRemainingVolume(remainingVolume),
           mFees(fees) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 4; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     unsigned long mFillVolume = 0;
     unsigned long mRemainingVolume = 0;
     signed long mFees = 0;
 };
 
-struct TradeTicksMessage : ISerialisable
+struct TradeTicksMessage : SerialisableMessage<TradeTicksMessage>
 {
     TradeTicksMessage() = default;
     TradeTicksMessage(Instrument instrument,
@@ -277,16 +242,6 @@ struct TradeTicksMessage : ISerialisable
               mBidPrices(bidPrices),
               mBidVolumes(bidVolumes) {}
 
-    std::size_t Size() const noexcept override
-    {
-        return MessageFieldSize::BYTE
-               + MessageFieldSize::LONG
-               + MessageFieldSize::LONG * TOP_LEVEL_COUNT * 4;
-    }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     Instrument mInstrument = Instrument::FUTURE;
     unsigned long mSequenceNumber = 0;
     std::array<unsigned long, TOP_LEVEL_COUNT> mAskPrices = {};
@@ -295,14 +250,320 @@ struct TradeTicksMessage : ISerialisable
     std::array<unsigned long, TOP_LEVEL_COUNT> mBidVolumes = {};
 };
 
+template<>
+struct MessageTraits<AmendMessage>
+{
+    static constexpr MessageType TYPE = MessageType::AMEND_ORDER;
+    using Layout = MessageLayout<Field<&AmendMessage::mClientOrderId, Wire::UInt32>,
+                                 Field<&AmendMessage::mNewVolume, Wire::UInt32>>;
+};
+
+template<>
+struct MessageTraits<CancelMessage>
+{
+    static constexpr MessageType TYPE = MessageType::CANCEL_ORDER;
+    using Layout = MessageLayout<Field<&CancelMessage::mClientOrderId, Wire::UInt32>>;
+};
+
+template<>
+struct MessageTraits<ErrorMessage>
+{
+    static constexpr MessageType TYPE = MessageType::ERROR_MESSAGE;
+    using Layout = MessageLayout<Field<&ErrorMessage::mClientOrderId, Wire::UInt32>,
+                                 Field<&ErrorMessage::mMessage, Wire::String<MessageFieldSize::STRING>>>;
+};
+
+template<>
+struct MessageTraits<HedgeMessage>
+{
+    static constexpr MessageType TYPE = MessageType::HEDGE_ORDER;
+    using Layout = MessageLayout<Field<&HedgeMessage::mClientOrderId, Wire::UInt32>,
+                                 Field<&HedgeMessage::mSide, Wire::Byte>,
+                                 Field<&HedgeMessage::mPrice, Wire::UInt32>,
+                                 Field<&HedgeMessage::mVolume, Wire::UInt32>>;
+};
+
+template<>
+struct MessageTraits<HedgeFilledMessage>
+{
+    static constexpr MessageType TYPE = MessageType::HEDGE_FILLED;
+    using Layout = MessageLayout<Field<&HedgeFilledMessage::mClientOrderId, Wire::UInt32>,
+                                 Field<&HedgeFilledMessage::mPrice, Wire::UInt32>,
+                                 Field<&HedgeFilledMessage::mVolume, Wire::UInt32>>;
+};
+
+template<>
+struct MessageTraits<InsertMessage>
+{
+    static constexpr MessageType TYPE = MessageType::INSERT_ORDER;
+    using Layout = MessageLayout<Field<&InsertMessage::mClientOrderId, Wire::UInt32>,
+                                 Field<&InsertMessage::mSide, Wire::Byte>,
+                                 Field<&InsertMessage::mPrice, Wire::UInt32>,
+                                 Field<&InsertMessage::mVolume, Wire::UInt32>,
+                                 Field<&InsertMessage::mLifespan, Wire::Byte>>;
+};
+
+template<>
+struct MessageTraits<LoginMessage>
+{
+    static constexpr MessageType TYPE = MessageType::LOGIN;
+    using Layout = MessageLayout<Field<&LoginMessage::mName, Wire::String<MessageFieldSize::STRING>>,
+                                 Field<&LoginMessage::mSecret, Wire::String<MessageFieldSize::STRING>>>;
+};
+
+template<>
+struct MessageTraits<OrderBookMessage>
+{
+    static constexpr MessageType TYPE = MessageType::ORDER_BOOK_UPDATE;
+    using Layout = MessageLayout<Field<&OrderBookMessage::mInstrument, Wire::Byte>,
+                                 Field<&OrderBookMessage::mSequenceNumber, Wire::UInt32>,
+                                 Field<&OrderBookMessage::mAskPrices, Wire::Array<Wire::UInt32, TOP_LEVEL_COUNT>>,
+                                 Field<&OrderBookMessage::mAskVolumes, Wire::Array<Wire::UInt32, TOP_LEVEL_COUNT>>,
+                                 Field<&OrderBookMessage::mBidPrices, Wire::Array<Wire::UInt32, TOP_LEVEL_COUNT>>,
+                                 Field<&OrderBookMessage::mBidVolumes, Wire::Array<Wire::UInt32, TOP_LEVEL_COUNT>>>;
+};
+
+template<>
+struct MessageTraits<OrderFilledMessage>
+{
+    static constexpr MessageType TYPE = MessageType::ORDER_FILLED;
+    using Layout = MessageLayout<Field<&OrderFilledMessage::mClientOrderId, Wire::UInt32>,
+                                 Field<&OrderFilledMessage::mPrice, Wire::UInt32>,
+                                 Field<&OrderFilledMessage::mVolume, Wire::UInt32>>;
+};
+
+template<>
+struct MessageTraits<OrderStatusMessage>
+{
+    static constexpr MessageType TYPE = MessageType::ORDER_STATUS;
+    using Layout = MessageLayout<Field<&OrderStatusMessage::mClientOrderId, Wire::UInt32>,
+                                 Field<&OrderStatusMessage::mFillVolume, Wire::UInt32>,
+                                 Field<&OrderStatusMessage::mRemainingVolume, Wire::UInt32>,
+                                 Field<&OrderStatusMessage::mFees, Wire::Int32>>;
+};
+
+template<>
+struct MessageTraits<TradeTicksMessage>
+{
+    static constexpr MessageType TYPE = MessageType::TRADE_TICKS;
+    using Layout = MessageLayout<Field<&TradeTicksMessage::mInstrument, Wire::Byte>,
+                                 Field<&TradeTicksMessage::mSequenceNumber, Wire::UInt32>,
+                                 Field<&TradeTicksMessage::mAskPrices, Wire::Array<Wire::UInt32, TOP_LEVEL_COUNT>>,
+                                 Field<&TradeTicksMessage::mAskVolumes, Wire::Array<Wire::UInt32, TOP_LEVEL_COUNT>>,
+                                 Field<&TradeTicksMessage::mBidPrices, Wire::Array<Wire::UInt32, TOP_LEVEL_COUNT>>,
+                                 Field<&TradeTicksMessage::mBidVolumes, Wire::Array<Wire::UInt32, TOP_LEVEL_COUNT>>>;
+};
+
+// The layouts must match the exchange's.
+static_assert(MessageTraits<AmendMessage>::Layout::SIZE == 8, "unexpected amend message size");
+static_assert(MessageTraits<CancelMessage>::Layout::SIZE == 4, "unexpected cancel message size");
+static_assert(MessageTraits<ErrorMessage>::Layout::SIZE == 54, "unexpected error message size");
+static_assert(MessageTraits<HedgeMessage>::Layout::SIZE == 13, "unexpected hedge message size");
+static_assert(MessageTraits<InsertMessage>::Layout::SIZE == 14, "unexpected insert message size");
+static_assert(MessageTraits<LoginMessage>::Layout::SIZE == 100, "unexpected login message size");
+static_assert(MessageTraits<OrderBookMessage>::Layout::SIZE == 85, "unexpected order book message size");
+static_assert(MessageTraits<OrderStatusMessage>::Layout::SIZE == 16, "unexpected order status message size");
+
+// What an error message from the exchange is about, so that a strategy can
+// act on it without comparing strings.
+enum class ErrorCode : unsigned char
+{
+    UNKNOWN,
+    ACTIVE_ORDER_COUNT_LIMIT_BREACHED,
+    ACTIVE_ORDER_VOLUME_LIMIT_BREACHED,
+    AMEND_WOULD_INCREASE_VOLUME,
+    CANNOT_DETERMINE_FUTURE_PRICE,
+    DUPLICATE_CLIENT_ORDER_ID,
+    ETF_POSITION_LIMIT_BREACHED,
+    FUTURE_POSITION_LIMIT_BREACHED,
+    IN_CROSS_WITH_EXISTING_ORDER,
+    INVALID_LIFESPAN,
+    INVALID_PRICE,
+    INVALID_SIDE,
+    INVALID_VOLUME,
+    MARKET_NOT_YET_OPEN,
+    MESSAGE_FREQUENCY_LIMIT_BREACHED,
+    OUT_OF_ORDER_AMEND,
+    OUT_OF_ORDER_CANCEL,
+    PRICE_NOT_MULTIPLE_OF_TICK_SIZE,
+    UNHEDGED_LOTS_TIME_LIMIT_BREACHED
+};
+
+// Map the text of an error message, as sent by the exchange, to its code.
+// Texts that start with the offending value are matched on their suffix.
+inline ErrorCode errorCodeFromMessage(std::string_view message) noexcept
+{
+    struct Text
+    {
+        std::string_view mText;
+        ErrorCode mCode;
+    };
+    static constexpr Text texts[] = {
+        {"order rejected: active order count limit breached", ErrorCode::ACTIVE_ORDER_COUNT_LIMIT_BREACHED},
+        {"order rejected: active order volume limit breached", ErrorCode::ACTIVE_ORDER_VOLUME_LIMIT_BREACHED},
+        {"amend operation would increase order volume", ErrorCode::AMEND_WOULD_INCREASE_VOLUME},
+        {"order rejected: cannot determine future price", ErrorCode::CANNOT_DETERMINE_FUTURE_PRICE},
+        {"duplicate or out-of-order client_order_id", ErrorCode::DUPLICATE_CLIENT_ORDER_ID},
+        {"ETF position limit breached", ErrorCode::ETF_POSITION_LIMIT_BREACHED},
+        {"future position limit breached", ErrorCode::FUTURE_POSITION_LIMIT_BREACHED},
+        {"order rejected: in cross with an existing order", ErrorCode::IN_CROSS_WITH_EXISTING_ORDER},
+        {"order rejected: market not yet open", ErrorCode::MARKET_NOT_YET_OPEN},
+        {"message frequency limit breached", ErrorCode::MESSAGE_FREQUENCY_LIMIT_BREACHED},
+        {"out-of-order client_order_id in amend message", ErrorCode::OUT_OF_ORDER_AMEND},
+        {"out-of-order client_order_id in cancel message", ErrorCode::OUT_OF_ORDER_CANCEL},
+        {"price is not a multiple of tick size", ErrorCode::PRICE_NOT_MULTIPLE_OF_TICK_SIZE},
+        {"held unhedged lots for longer than the time limit", ErrorCode::UNHEDGED_LOTS_TIME_LIMIT_BREACHED}};
+    static constexpr Text suffixes[] = {
+        {" is not a valid lifespan", ErrorCode::INVALID_LIFESPAN},
+        {" is not a valid price", ErrorCode::INVALID_PRICE},
+        {" is not a valid side", ErrorCode::INVALID_SIDE},
+        {" is not a valid volume", ErrorCode::INVALID_VOLUME}};
+
+    for (const auto& text : texts)
+    {
+        if (message == text.mText)
+            return text.mCode;
+    }
+    for (const auto& suffix : suffixes)
+    {
+        if (message.size() >= suffix.mText.size()
+            && message.substr(message.size() - suffix.mText.size()) == suffix.mText)
+            return suffix.mCode;
+    }
+    return ErrorCode::UNKNOWN;
+}
+
+// Views of received execution messages that decode each field straight
+// from the received bytes, rather than copying the whole message first. The
+// bytes must outlive the view.
+class ErrorMessageView
+{
+public:
+    explicit ErrorMessageView(unsigned char const* data) : mData(data) {}
+
+    unsigned long GetClientOrderId() const { return Layout::Get<&ErrorMessage::mClientOrderId>(mData); }
+    std::string_view GetMessage() const
+    {
+        return Wire::String<MessageFieldSize::STRING>::Decode<std::string_view>(
+            mData + Layout::OffsetOf<&ErrorMessage::mMessage>());
+    }
+    ErrorCode GetCode() const { return errorCodeFromMessage(GetMessage()); }
+
+private:
+    using Layout = MessageTraits<ErrorMessage>::Layout;
+
+    unsigned char const* mData;
+};
+
+class HedgeFilledMessageView
+{
+public:
+    explicit HedgeFilledMessageView(unsigned char const* data) : mData(data) {}
+
+    unsigned long GetClientOrderId() const { return Layout::Get<&HedgeFilledMessage::mClientOrderId>(mData); }
+    unsigned long GetPrice() const { return Layout::Get<&HedgeFilledMessage::mPrice>(mData); }
+    unsigned long GetVolume() const { return Layout::Get<&HedgeFilledMessage::mVolume>(mData); }
+
+private:
+    using Layout = MessageTraits<HedgeFilledMessage>::Layout;
+
+    unsigned char const* mData;
+};
+
+class OrderFilledMessageView
+{
+public:
+    explicit OrderFilledMessageView(unsigned char const* data) : mData(data) {}
+
+    unsigned long GetClientOrderId() const { return Layout::Get<&OrderFilledMessage::mClientOrderId>(mData); }
+    unsigned long GetPrice() const { return Layout::Get<&OrderFilledMessage::mPrice>(mData); }
+    unsigned long GetVolume() const { return Layout::Get<&OrderFilledMessage::mVolume>(mData); }
+
+private:
+    using Layout = MessageTraits<OrderFilledMessage>::Layout;
+
+    unsigned char const* mData;
+};
+
+class OrderStatusMessageView
+{
+public:
+    explicit OrderStatusMessageView(unsigned char const* data) : mData(data) {}
+
+    unsigned long GetClientOrderId() const { return Layout::Get<&OrderStatusMessage::mClientOrderId>(mData); }
+    unsigned long GetFillVolume() const { return Layout::Get<&OrderStatusMessage::mFillVolume>(mData); }
+    unsigned long GetRemainingVolume() const { return Layout::Get<&OrderStatusMessage::mRemainingVolume>(mData); }
+    signed long GetFees() const { return Layout::Get<&OrderStatusMessage::mFees>(mData); }
+
+private:
+    using Layout = MessageTraits<OrderStatusMessage>::Layout;
+
+    unsigned char const* mData;
+};
+
 template<class T>
-T makeMessage(unsigned char const* data, std::size_t size)
+T makeMessage(unsigned char const* data, std::size_t)
 {
     T message;
-    message.Deserialise(data, size);
+    MessageTraits<T>::Layout::Decode(message, data);
     return message;
 }
 
+template<typename Message>
+void IConnection::SendMessage(const Message& message, SendMode mode)
+{
+    using Traits = MessageTraits<Message>;
+    constexpr std::size_t size = MESSAGE_HEADER_SIZE + Traits::Layout::SIZE;
+    unsigned char* data = Prepare(size);
+    boost::endian::store_big_u16(data, static_cast<std::uint16_t>(size));
+    data[MESSAGE_TYPE_OFFSET] = Traits::TYPE;
+    Traits::Layout::Encode(message, data + MESSAGE_HEADER_SIZE);
+    Commit(size, mode);
+}
+
+// A message encoded once, header included, so that sending another like it
+// only copies the bytes and rewrites the fields that differ.
+template<typename Message>
+class MessageTemplate
+{
+public:
+    using Layout = typename MessageTraits<Message>::Layout;
+    static constexpr std::size_t SIZE = MESSAGE_HEADER_SIZE + Layout::SIZE;
+
+    MessageTemplate() : MessageTemplate(Message{}) {}
+    explicit MessageTemplate(const Message& message) { Reset(message); }
+
+    void Reset(const Message& message) noexcept
+    {
+        boost::endian::store_big_u16(mBytes.data(), static_cast<std::uint16_t>(SIZE));
+        mBytes[MESSAGE_TYPE_OFFSET] = MessageTraits<Message>::TYPE;
+        Layout::Encode(message, mBytes.data() + MESSAGE_HEADER_SIZE);
+    }
+
+    // Rewrite one field of the template itself.
+    template<auto Member, typename Value>
+    void Set(const Value& value) noexcept
+    {
+        Layout::template Set<Member>(mBytes.data() + MESSAGE_HEADER_SIZE, value);
+    }
+
+    // Send a copy of the template with the given members' fields replaced by
+    // the given values, e.g.
+    //     Send<&CancelMessage::mClientOrderId>(connection, SendMode::ASAP, id).
+    template<auto... Members, typename... Values>
+    void Send(IConnection& connection, SendMode mode, const Values&... values) const
+    {
+        static_assert(sizeof...(Members) == sizeof...(Values), "one value is needed for each member");
+        unsigned char* data = connection.Prepare(SIZE);
+        std::memcpy(data, mBytes.data(), SIZE);
+        (Layout::template Set<Members>(data + MESSAGE_HEADER_SIZE, values), ...);
+        connection.Commit(SIZE, mode);
+    }
+
+private:
+    std::array<unsigned char, SIZE> mBytes = {};
+};
+
 }
 
 #endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_PROTOCOL_H
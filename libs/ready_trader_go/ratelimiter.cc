@@ -0,0 +1,128 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <utility>
+
+#include "error.h"
+#include "logging.h"
+#include "ratelimiter.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_RATE, "RATE")
+
+namespace ReadyTraderGo {
+
+static_assert((RATE_LIMITER_CAPACITY & (RATE_LIMITER_CAPACITY - 1)) == 0,
+              "rate limiter capacity must be a power of two");
+
+RateLimiter::RateLimiter(ITimerSource& timers, std::size_t limit, Clock::duration window)
+    : mTimers(timers), mLimit(limit), mWindow(window), mTimer(timers.CreateTimer())
+{
+    if (limit == 0 || limit > RATE_LIMITER_CAPACITY)
+        throw ReadyTraderGoError("rate limiter limit must be between one and RATE_LIMITER_CAPACITY");
+}
+
+void RateLimiter::Expire(Clock::time_point now) noexcept
+{
+    while (mCount != 0 && now - mSent[mHead] > mWindow)
+    {
+        mHead = (mHead + 1) & (RATE_LIMITER_CAPACITY - 1);
+        --mCount;
+    }
+}
+
+std::size_t RateLimiter::GetUsed(Clock::time_point now) noexcept
+{
+    Expire(now);
+    return mCount + mQueue.size();
+}
+
+void RateLimiter::Record(Clock::time_point now) noexcept
+{
+    Expire(now);
+    if (mCount == RATE_LIMITER_CAPACITY)
+    {
+        // Only reachable if callers ignore the limit; forget the oldest.
+        mHead = (mHead + 1) & (RATE_LIMITER_CAPACITY - 1);
+        --mCount;
+    }
+    mSent[(mHead + mCount) & (RATE_LIMITER_CAPACITY - 1)] = now;
+    ++mCount;
+}
+
+void RateLimiter::Submit(std::function<void()> send)
+{
+    const auto now = mTimers.Now();
+    Expire(now);
+    if (mQueue.empty() && mCount < mLimit)
+    {
+        Record(now);
+        send();
+        return;
+    }
+
+    if (mQueue.empty())
+        RLOG(LG_RATE, LogLevel::LL_INFO) << "message limit reached, deferring messages";
+    mQueue.push_back(std::move(send));
+    ArmTimer();
+}
+
+void RateLimiter::NotifyOnExpiry(std::function<void()> expired)
+{
+    mExpired = std::move(expired);
+    ArmTimer();
+}
+
+void RateLimiter::ArmTimer()
+{
+    if (mTimerArmed)
+        return;
+
+    // A message expires once it is strictly older than the window.
+    mTimerArmed = true;
+    mTimer->AsyncWaitUntil(mCount ? mSent[mHead] + mWindow + Clock::duration(1) : mTimers.Now(),
+                           [this]() { TimerHandler(); });
+}
+
+void RateLimiter::TimerHandler()
+{
+    mTimerArmed = false;
+
+    const auto now = mTimers.Now();
+    Expire(now);
+    const bool wasQueued = !mQueue.empty();
+    while (!mQueue.empty() && mCount < mLimit)
+    {
+        auto send = std::move(mQueue.front());
+        mQueue.pop_front();
+        Record(now);
+        send();
+    }
+    if (wasQueued && mQueue.empty())
+        RLOG(LG_RATE, LogLevel::LL_INFO) << "sent all deferred messages";
+
+    if (mExpired && mQueue.empty())
+    {
+        auto expired = std::move(mExpired);
+        mExpired = nullptr;
+        expired();
+    }
+
+    if (!mQueue.empty() || mExpired)
+        ArmTimer();
+}
+
+}
@@ -0,0 +1,91 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_RATELIMITER_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_RATELIMITER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "timersource.h"
+
+namespace ReadyTraderGo {
+
+// Most messages a RateLimiter can allow per window. Must be a power of two.
+constexpr std::size_t RATE_LIMITER_CAPACITY = 64;
+
+// Keeps the number of messages sent within a sliding window under a limit,
+// like the exchange's limit on messages per second.
+//
+// The send time of each message in the window is kept in a ring, so
+// recording a send and expiring old ones are both O(1) (amortised). Sends
+// that would exceed the limit can be queued with Submit; a timer runs them,
+// oldest first, as soon as the window has room, so nothing ever waits by
+// blocking the event loop. Time is kept by the given timer source.
+class RateLimiter
+{
+public:
+    using Clock = ITimerSource::Clock;
+
+    // Throws ReadyTraderGoError if the limit exceeds RATE_LIMITER_CAPACITY.
+    RateLimiter(ITimerSource& timers, std::size_t limit, Clock::duration window);
+
+    // Messages sent within the window plus those queued to be sent.
+    std::size_t GetUsed() { return GetUsed(mTimers.Now()); }
+    std::size_t GetUsed(Clock::time_point now) noexcept;
+    std::size_t GetQueued() const noexcept { return mQueue.size(); }
+
+    // Count a message sent outside Submit. The caller is responsible for
+    // having checked there was room for it.
+    void Record() { Record(mTimers.Now()); }
+    void Record(Clock::time_point now) noexcept;
+
+    // Run send now if there is room in the window and nothing is queued
+    // ahead of it, otherwise queue it to run as soon as there is.
+    void Submit(std::function<void()> send);
+
+    // Call expired once, from the event loop, when the oldest message
+    // leaves the window (straight away if the window is empty) and nothing
+    // queued by Submit is waiting. Replaces a previous callback that has not
+    // been called yet.
+    void NotifyOnExpiry(std::function<void()> expired);
+
+private:
+    void Expire(Clock::time_point now) noexcept;
+    void ArmTimer();
+    void TimerHandler();
+
+    ITimerSource& mTimers;
+    std::size_t mLimit;
+    Clock::duration mWindow;
+    std::array<Clock::time_point, RATE_LIMITER_CAPACITY> mSent = {};
+    std::size_t mHead = 0;
+    std::size_t mCount = 0;
+
+    std::deque<std::function<void()>> mQueue;
+    std::function<void()> mExpired;
+    std::unique_ptr<ITimer> mTimer;
+    bool mTimerArmed = false;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_RATELIMITER_H
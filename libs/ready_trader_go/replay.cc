@@ -0,0 +1,593 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iterator>
+#include <string>
+
+#include <boost/asio/post.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include "connectivity.h"
+#include "error.h"
+#include "logging.h"
+#include "replay.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_SIM, "SIM")
+
+namespace ReadyTraderGo {
+
+constexpr std::size_t FUTURE_INDEX = static_cast<std::size_t>(Instrument::FUTURE);
+constexpr std::size_t ETF_INDEX = static_cast<std::size_t>(Instrument::ETF);
+
+class ReplayTimerSource::Timer : public ITimer
+{
+public:
+    explicit Timer(ReplayTimerSource& source) : mSource(source)
+    {
+        mSource.mTimers.push_back(this);
+    }
+
+    ~Timer() override
+    {
+        auto& timers = mSource.mTimers;
+        timers.erase(std::remove(timers.begin(), timers.end(), this), timers.end());
+    }
+
+    void AsyncWaitUntil(Clock::time_point when, std::function<void()> handler) override
+    {
+        mExpiry = when;
+        mHandler = std::move(handler);
+        mIsWaiting = true;
+    }
+
+    ReplayTimerSource& mSource;
+    Clock::time_point mExpiry;
+    std::function<void()> mHandler;
+    bool mIsWaiting = false;
+};
+
+std::unique_ptr<ITimer> ReplayTimerSource::CreateTimer()
+{
+    return std::make_unique<Timer>(*this);
+}
+
+ReplayTimerSource::Timer* ReplayTimerSource::GetEarliest() const
+{
+    Timer* earliest = nullptr;
+    for (Timer* timer : mTimers)
+    {
+        if (timer->mIsWaiting && (earliest == nullptr || timer->mExpiry < earliest->mExpiry))
+            earliest = timer;
+    }
+    return earliest;
+}
+
+void ReplayTimerSource::Run(Timer& timer)
+{
+    if (timer.mExpiry > mNow)
+        mNow = timer.mExpiry;
+    timer.mIsWaiting = false;
+
+    // The handler may wait on the timer again, replacing itself.
+    auto handler = std::move(timer.mHandler);
+    handler();
+}
+
+void ReplayTimerSource::AdvanceTo(Clock::time_point now)
+{
+    Timer* timer;
+    while ((timer = GetEarliest()) != nullptr && timer->mExpiry <= now)
+        Run(*timer);
+
+    if (now > mNow)
+        mNow = now;
+}
+
+bool ReplayTimerSource::RunNext()
+{
+    Timer* timer = GetEarliest();
+    if (timer == nullptr)
+        return false;
+    Run(*timer);
+    return true;
+}
+
+SimulatedConnection::SimulatedConnection(boost::asio::io_context& context,
+                                         const SimulationOptions& options,
+                                         ITimerSource& timers)
+    : mContext(context), mOptions(options), mTimers(timers)
+{
+}
+
+SimulatedConnection::~SimulatedConnection()
+{
+    RLOG(LG_SIM, LogLevel::LL_INFO) << "simulated exchange closing: etf_position=" << mEtfPosition
+                                    << " future_position=" << mFuturePosition
+                                    << " etf_volume_traded=" << mEtfVolumeTraded
+                                    << " total_fees=" << mTotalFees
+                                    << " profit_or_loss=" << GetProfitOrLoss()
+                                    << " errors=" << mErrorCount;
+}
+
+signed long SimulatedConnection::GetProfitOrLoss() const
+{
+    return mCash
+           + mEtfPosition * static_cast<signed long>(GetMarkPrice(Instrument::ETF))
+           + mFuturePosition * static_cast<signed long>(GetMarkPrice(Instrument::FUTURE));
+}
+
+unsigned char* SimulatedConnection::Prepare(std::size_t size)
+{
+    if (size > mOutbound.size())
+        throw ReadyTraderGoError("simulated exchange received message that is too large");
+    return mOutbound.data();
+}
+
+void SimulatedConnection::Commit(std::size_t size, SendMode)
+{
+    if (mIsBreached)
+        return;
+
+    const auto now = mTimers.Now();
+    while (!mMessageTimes.empty() && now - mMessageTimes.front() >= mOptions.mMessageFrequencyInterval)
+        mMessageTimes.pop_front();
+    mMessageTimes.push_back(now);
+    if (mMessageTimes.size() > mOptions.mMessageFrequencyLimit)
+    {
+        Breach(0, "message frequency limit breached");
+        return;
+    }
+
+    // Messages go through the wire format so the simulation sees exactly
+    // what the exchange would.
+    const unsigned char messageType = mOutbound[MESSAGE_TYPE_OFFSET];
+    unsigned char const* data = mOutbound.data() + MESSAGE_HEADER_SIZE;
+    size -= MESSAGE_HEADER_SIZE;
+
+    switch (messageType)
+    {
+    case MessageType::AMEND_ORDER:
+        AmendOrder(makeMessage<AmendMessage>(data, size));
+        break;
+    case MessageType::CANCEL_ORDER:
+        CancelOrder(makeMessage<CancelMessage>(data, size));
+        break;
+    case MessageType::HEDGE_ORDER:
+        HedgeOrder(makeMessage<HedgeMessage>(data, size));
+        break;
+    case MessageType::INSERT_ORDER:
+        InsertOrder(makeMessage<InsertMessage>(data, size));
+        break;
+    case MessageType::LOGIN:
+        break;
+    default:
+        RLOG(LG_SIM, LogLevel::LL_ERROR) << "simulated exchange received message with unexpected type: "
+                                         << static_cast<int>(messageType);
+        throw ReadyTraderGoError("simulated exchange received message with unexpected type");
+    }
+}
+
+void SimulatedConnection::OnInformationMessage(unsigned char messageType, unsigned char const* data, std::size_t size)
+{
+    if (messageType == MessageType::ORDER_BOOK_UPDATE)
+    {
+        auto book = makeMessage<OrderBookMessage>(data, size);
+        mBooks[static_cast<std::size_t>(book.mInstrument)] = book;
+    }
+    else if (messageType == MessageType::TRADE_TICKS)
+    {
+        auto ticks = makeMessage<TradeTicksMessage>(data, size);
+        const std::size_t index = static_cast<std::size_t>(ticks.mInstrument);
+        if (ticks.mAskPrices[0] != 0)
+            mLastTradedPrices[index] = ticks.mAskPrices[0];
+        else if (ticks.mBidPrices[0] != 0)
+            mLastTradedPrices[index] = ticks.mBidPrices[0];
+
+        if (ticks.mInstrument == Instrument::ETF)
+            TradePassively(ticks);
+    }
+}
+
+void SimulatedConnection::AmendOrder(const AmendMessage& amend)
+{
+    if (amend.mClientOrderId > mLastClientOrderId)
+    {
+        SendError(amend.mClientOrderId, "out-of-order client_order_id in amend message");
+        return;
+    }
+
+    auto it = mOrders.find(amend.mClientOrderId);
+    if (it == mOrders.end())
+        return;
+
+    Order& order = it->second;
+    if (amend.mNewVolume > order.mVolume)
+    {
+        SendError(amend.mClientOrderId, "amend operation would increase order volume");
+        return;
+    }
+
+    const unsigned long fillVolume = order.mVolume - order.mRemainingVolume;
+    const unsigned long diff = order.mVolume - std::max(amend.mNewVolume, fillVolume);
+    order.mVolume -= diff;
+    order.mRemainingVolume -= diff;
+    mActiveVolume -= diff;
+    Reply(MessageType::ORDER_STATUS, OrderStatusMessage{amend.mClientOrderId,
+                                                        order.mVolume - order.mRemainingVolume,
+                                                        order.mRemainingVolume,
+                                                        order.mFees});
+    if (order.mRemainingVolume == 0)
+        mOrders.erase(it);
+}
+
+void SimulatedConnection::CancelOrder(const CancelMessage& cancel)
+{
+    if (cancel.mClientOrderId > mLastClientOrderId)
+    {
+        SendError(cancel.mClientOrderId, "out-of-order client_order_id in cancel message");
+        return;
+    }
+
+    auto it = mOrders.find(cancel.mClientOrderId);
+    if (it == mOrders.end())
+        return;
+
+    Order& order = it->second;
+    const unsigned long removed = order.mRemainingVolume;
+    order.mRemainingVolume = 0;
+    mActiveVolume -= removed;
+    Reply(MessageType::ORDER_STATUS, OrderStatusMessage{cancel.mClientOrderId,
+                                                        order.mVolume - removed,
+                                                        0,
+                                                        order.mFees});
+    mOrders.erase(it);
+}
+
+void SimulatedConnection::HedgeOrder(const HedgeMessage& hedge)
+{
+    if (!CheckOrder(hedge.mClientOrderId, hedge.mSide, hedge.mPrice, hedge.mVolume))
+        return;
+
+    // Like the exchange, hedge orders are always filled in full, at the
+    // average price of the volume available within the limit price.
+    const OrderBookMessage& book = mBooks[FUTURE_INDEX];
+    const bool isBuy = hedge.mSide == Side::BUY;
+    const auto& prices = isBuy ? book.mAskPrices : book.mBidPrices;
+    const auto& volumes = isBuy ? book.mAskVolumes : book.mBidVolumes;
+
+    unsigned long tradedVolume = 0;
+    unsigned long tradedValue = 0;
+    for (std::size_t i = 0; i < TOP_LEVEL_COUNT && tradedVolume < hedge.mVolume; ++i)
+    {
+        if (prices[i] == 0 || (isBuy ? prices[i] > hedge.mPrice : prices[i] < hedge.mPrice))
+            break;
+        const unsigned long volume = std::min(hedge.mVolume - tradedVolume, volumes[i]);
+        tradedVolume += volume;
+        tradedValue += volume * prices[i];
+    }
+
+    const unsigned long averagePrice = (tradedVolume > 0) ? tradedValue / tradedVolume
+                                                          : GetMarkPrice(Instrument::FUTURE);
+    if (averagePrice == 0)
+    {
+        SendError(hedge.mClientOrderId, "order rejected: cannot determine future price");
+        return;
+    }
+
+    const signed long value = static_cast<signed long>(averagePrice * hedge.mVolume);
+    mFuturePosition += isBuy ? static_cast<long>(hedge.mVolume) : -static_cast<long>(hedge.mVolume);
+    mCash += isBuy ? -value : value;
+    Reply(MessageType::HEDGE_FILLED, HedgeFilledMessage{hedge.mClientOrderId, averagePrice, hedge.mVolume});
+
+    if (std::labs(mFuturePosition) > mOptions.mPositionLimit)
+        Breach(hedge.mClientOrderId, "future position limit breached");
+}
+
+void SimulatedConnection::InsertOrder(const InsertMessage& insert)
+{
+    if (!CheckOrder(insert.mClientOrderId, insert.mSide, insert.mPrice, insert.mVolume))
+        return;
+
+    if (insert.mLifespan != Lifespan::FILL_AND_KILL && insert.mLifespan != Lifespan::GOOD_FOR_DAY)
+    {
+        SendError(insert.mClientOrderId, std::to_string(static_cast<int>(insert.mLifespan))
+                                         + " is not a valid lifespan");
+        return;
+    }
+
+    if (mOrders.size() >= mOptions.mActiveOrderCountLimit)
+    {
+        SendError(insert.mClientOrderId, "order rejected: active order count limit breached");
+        return;
+    }
+
+    if (mActiveVolume + insert.mVolume > mOptions.mActiveVolumeLimit)
+    {
+        SendError(insert.mClientOrderId, "order rejected: active order volume limit breached");
+        return;
+    }
+
+    for (const auto& entry : mOrders)
+    {
+        const Order& other = entry.second;
+        if (other.mSide != insert.mSide && (insert.mSide == Side::BUY ? insert.mPrice >= other.mPrice
+                                                                     : insert.mPrice <= other.mPrice))
+        {
+            SendError(insert.mClientOrderId, "order rejected: in cross with an existing order");
+            return;
+        }
+    }
+
+    Order order{insert.mSide, insert.mLifespan, insert.mPrice, insert.mVolume, insert.mVolume, 0};
+    mActiveVolume += insert.mVolume;
+
+    OrderBookMessage& book = mBooks[ETF_INDEX];
+    const bool isBuy = insert.mSide == Side::BUY;
+    const auto& prices = isBuy ? book.mAskPrices : book.mBidPrices;
+    auto& volumes = isBuy ? book.mAskVolumes : book.mBidVolumes;
+    for (std::size_t i = 0; i < TOP_LEVEL_COUNT && order.mRemainingVolume > 0 && !mIsBreached; ++i)
+    {
+        if (prices[i] == 0 || (isBuy ? prices[i] > insert.mPrice : prices[i] < insert.mPrice))
+            break;
+        const unsigned long volume = std::min(order.mRemainingVolume, volumes[i]);
+        if (volume > 0)
+        {
+            volumes[i] -= volume;
+            Fill(insert.mClientOrderId, order, prices[i], volume, mOptions.mTakerFee);
+        }
+    }
+
+    if (order.mRemainingVolume == 0 || mIsBreached)
+        return;
+
+    if (order.mLifespan == Lifespan::FILL_AND_KILL)
+    {
+        const unsigned long removed = order.mRemainingVolume;
+        order.mRemainingVolume = 0;
+        mActiveVolume -= removed;
+        Reply(MessageType::ORDER_STATUS, OrderStatusMessage{insert.mClientOrderId,
+                                                            order.mVolume - removed,
+                                                            0,
+                                                            order.mFees});
+        return;
+    }
+
+    // Only report the order being placed if it has not partially filled.
+    if (order.mRemainingVolume == order.mVolume)
+        Reply(MessageType::ORDER_STATUS, OrderStatusMessage{insert.mClientOrderId, 0, order.mVolume, 0});
+    mOrders.emplace(insert.mClientOrderId, order);
+}
+
+void SimulatedConnection::TradePassively(const TradeTicksMessage& ticks)
+{
+    // Someone trading at or through the price of a resting order would have
+    // traded with it first. Orders are filled in client order id order,
+    // which approximates time priority.
+    auto askVolumes = ticks.mAskVolumes;
+    auto bidVolumes = ticks.mBidVolumes;
+
+    for (auto it = mOrders.begin(); it != mOrders.end() && !mIsBreached;)
+    {
+        Order& order = it->second;
+        const bool isBuy = order.mSide == Side::BUY;
+        const auto& prices = isBuy ? ticks.mBidPrices : ticks.mAskPrices;
+        auto& volumes = isBuy ? bidVolumes : askVolumes;
+        for (std::size_t i = 0; i < TOP_LEVEL_COUNT && order.mRemainingVolume > 0 && !mIsBreached; ++i)
+        {
+            if (prices[i] == 0 || (isBuy ? prices[i] > order.mPrice : prices[i] < order.mPrice))
+                continue;
+            const unsigned long volume = std::min(order.mRemainingVolume, volumes[i]);
+            if (volume > 0)
+            {
+                volumes[i] -= volume;
+                Fill(it->first, order, order.mPrice, volume, mOptions.mMakerFee);
+            }
+        }
+        it = (order.mRemainingVolume == 0) ? mOrders.erase(it) : std::next(it);
+    }
+}
+
+bool SimulatedConnection::CheckOrder(unsigned long clientOrderId, Side side, unsigned long price,
+                                     unsigned long volume)
+{
+    if (clientOrderId <= mLastClientOrderId)
+    {
+        SendError(clientOrderId, "duplicate or out-of-order client_order_id");
+        return false;
+    }
+
+    mLastClientOrderId = clientOrderId;
+
+    if (side != Side::BUY && side != Side::SELL)
+    {
+        SendError(clientOrderId, std::to_string(static_cast<int>(side)) + " is not a valid side");
+        return false;
+    }
+
+    if (price < MINIMUM_BID || price > MAXIMUM_ASK)
+    {
+        SendError(clientOrderId, std::to_string(price) + " is not a valid price");
+        return false;
+    }
+
+    if (price % mOptions.mTickSize != 0)
+    {
+        SendError(clientOrderId, "price is not a multiple of tick size");
+        return false;
+    }
+
+    if (volume < 1)
+    {
+        SendError(clientOrderId, std::to_string(volume) + " is not a valid volume");
+        return false;
+    }
+
+    return true;
+}
+
+void SimulatedConnection::Fill(unsigned long clientOrderId, Order& order, unsigned long price,
+                               unsigned long volume, double feeRate)
+{
+    const signed long value = static_cast<signed long>(price * volume);
+    const signed long fee = std::lround(static_cast<double>(value) * feeRate);
+
+    order.mRemainingVolume -= volume;
+    order.mFees += fee;
+    mActiveVolume -= volume;
+    mTotalFees += fee;
+    mEtfVolumeTraded += volume;
+    mLastTradedPrices[ETF_INDEX] = price;
+
+    if (order.mSide == Side::BUY)
+    {
+        mEtfPosition += static_cast<long>(volume);
+        mCash -= value + fee;
+    }
+    else
+    {
+        mEtfPosition -= static_cast<long>(volume);
+        mCash += value - fee;
+    }
+
+    Reply(MessageType::ORDER_FILLED, OrderFilledMessage{clientOrderId, price, volume});
+    Reply(MessageType::ORDER_STATUS, OrderStatusMessage{clientOrderId,
+                                                        order.mVolume - order.mRemainingVolume,
+                                                        order.mRemainingVolume,
+                                                        order.mFees});
+
+    if (std::labs(mEtfPosition) > mOptions.mPositionLimit)
+        Breach(clientOrderId, "ETF position limit breached");
+}
+
+unsigned long SimulatedConnection::GetMarkPrice(Instrument instrument) const
+{
+    const std::size_t index = static_cast<std::size_t>(instrument);
+    if (mLastTradedPrices[index] != 0)
+        return mLastTradedPrices[index];
+
+    const OrderBookMessage& book = mBooks[index];
+    if (book.mAskPrices[0] != 0 && book.mBidPrices[0] != 0)
+        return (book.mAskPrices[0] + book.mBidPrices[0]) / 2;
+
+    return 0;
+}
+
+void SimulatedConnection::Reply(unsigned char messageType, const ISerialisable& serialisable)
+{
+    std::array<unsigned char, SIMULATED_MESSAGE_SIZE> buffer;
+    const std::size_t size = serialisable.Size();
+    serialisable.Serialise(buffer.data());
+    boost::asio::post(mContext, [this, messageType, buffer, size]() {
+        OnMessageReceipt(messageType, buffer.data(), size);
+    });
+}
+
+void SimulatedConnection::SendError(unsigned long clientOrderId, const std::string& message)
+{
+    ++mErrorCount;
+    RLOG(LG_SIM, LogLevel::LL_INFO) << "sent error message: client_order_id=" << clientOrderId
+                                    << " message=" << std::quoted(message, '\'');
+    Reply(MessageType::ERROR_MESSAGE, ErrorMessage{clientOrderId, message});
+}
+
+void SimulatedConnection::Breach(unsigned long clientOrderId, const std::string& message)
+{
+    // As the exchange does, report the breach and then disconnect.
+    SendError(clientOrderId, message);
+    mIsBreached = true;
+    boost::asio::post(mContext, [this]() { OnDisconnect(); });
+}
+
+ReplaySubscription::ReplaySubscription(boost::asio::io_context& context,
+                                       const std::string& filename,
+                                       SimulatedConnection& exchange,
+                                       ReplayTimerSource& timers)
+    : mContext(context), mReader(filename), mExchange(exchange), mTimers(timers)
+{
+    SetName(filename);
+
+    mHasNext = mReader.Next(mNext);
+    if (mHasNext)
+        mTimers.AdvanceTo(ReplayTimerSource::Clock::time_point(std::chrono::nanoseconds(mNext.mReceiveTime)));
+}
+
+void ReplaySubscription::AsyncReceive()
+{
+    std::weak_ptr<ISubscription> weak_this = shared_from_this();
+    boost::asio::post(mContext, [this, weak_this]() { Step(weak_this); });
+}
+
+void ReplaySubscription::Step(const std::weak_ptr<ISubscription>& weak_this)
+{
+    if (weak_this.expired())
+    {
+        // The 'this' object has been deleted out from underneath us!
+        return;
+    }
+
+    if (!mHasNext)
+    {
+        // Let anything the auto-trader deferred go out, with the exchange's
+        // replies handled in between.
+        if (mTimers.RunNext())
+        {
+            boost::asio::post(mContext, [this, weak_this]() { Step(weak_this); });
+            return;
+        }
+
+        RLOG(LG_SIM, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " replayed " << mMessageCount
+                                        << " messages covering " << GetReplayedDuration() / 1000000
+                                        << " milliseconds";
+        if (Finished)
+        {
+            Finished();
+        }
+        return;
+    }
+
+    const JournalRecord record = mNext;
+    mTimers.AdvanceTo(ReplayTimerSource::Clock::time_point(std::chrono::nanoseconds(record.mReceiveTime)));
+
+    if (mMessageCount++ == 0)
+        mFirstReceiveTime = record.mReceiveTime;
+    mLastReceiveTime = record.mReceiveTime;
+
+    const std::size_t messageLength = (record.mSize >= MESSAGE_HEADER_SIZE)
+                                      ? boost::endian::load_big_u16(record.mData) : 0;
+    if (messageLength < MESSAGE_HEADER_SIZE || messageLength != record.mSize)
+    {
+        RLOG(LG_SIM, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " malformed record with size="
+                                         << record.mSize;
+    }
+    else
+    {
+        const unsigned char messageType = record.mData[MESSAGE_TYPE_OFFSET];
+        mExchange.OnInformationMessage(messageType, record.mData + MESSAGE_HEADER_SIZE,
+                                       messageLength - MESSAGE_HEADER_SIZE);
+        OnMessageReceipt(messageType, record.mData + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE);
+    }
+
+    mHasNext = mReader.Next(mNext);
+    boost::asio::post(mContext, [this, weak_this]() { Step(weak_this); });
+}
+
+}
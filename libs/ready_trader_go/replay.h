@@ -0,0 +1,225 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_REPLAY_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_REPLAY_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include "connectivitytypes.h"
+#include "journal.h"
+#include "protocol.h"
+#include "timersource.h"
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// Large enough for any execution message.
+constexpr std::size_t SIMULATED_MESSAGE_SIZE = 128;
+
+// Exchange rules applied by the simulated exchange. The defaults match the
+// exchange's default configuration. Prices are in cents.
+struct SimulationOptions
+{
+    long mPositionLimit = 100;
+    std::size_t mActiveOrderCountLimit = 10;
+    unsigned long mActiveVolumeLimit = 200;
+    unsigned long mTickSize = 100;
+    double mMakerFee = -0.0001;
+    double mTakerFee = 0.0002;
+    std::size_t mMessageFrequencyLimit = 50;
+    std::chrono::steady_clock::duration mMessageFrequencyInterval = std::chrono::seconds(1);
+};
+
+// Keeps time as it was recorded in a journal. The ReplaySubscription moves
+// the clock to each message's receive time before the message is handled,
+// first running, in order of expiry, the handlers of any timers that expire
+// on the way.
+class ReplayTimerSource : public ITimerSource
+{
+public:
+    ReplayTimerSource() = default;
+
+    ReplayTimerSource(const ReplayTimerSource&) = delete;
+    void operator=(const ReplayTimerSource&) = delete;
+
+    Clock::time_point Now() override { return mNow; }
+    std::unique_ptr<ITimer> CreateTimer() override;
+
+    void AdvanceTo(Clock::time_point now);
+
+    // Move the clock to the earliest expiry of any waiting timer, if it is
+    // not already past it, and run that timer's handler. Returns false if
+    // no timer is waiting.
+    bool RunNext();
+
+private:
+    class Timer;
+
+    Timer* GetEarliest() const;
+    void Run(Timer& timer);
+
+    Clock::time_point mNow;
+    std::vector<Timer*> mTimers;
+};
+
+// Stands in for the exchange's execution connection when replaying a
+// journal.
+//
+// Orders are matched against the most recent order book for the ETF, with
+// each book's volume consumed as it trades. Good-for-day orders left in the
+// book trade passively against trade ticks at or through their price and
+// hedge orders trade against the most recent future order book. Replies are
+// posted to the io_context rather than delivered from within SendMessage,
+// much as they would arrive from a real exchange. The message frequency
+// limit is enforced on the replay's clock; the unhedged lots time limit is
+// not enforced.
+class SimulatedConnection : public IConnection
+{
+public:
+    SimulatedConnection(boost::asio::io_context& context,
+                        const SimulationOptions& options,
+                        ITimerSource& timers);
+    ~SimulatedConnection() override;
+
+    void AsyncRead() override {};
+    unsigned char* Prepare(std::size_t size) override;
+    void Commit(std::size_t size, SendMode mode) override;
+    void BeginBatch() override {};
+    void Flush() override {};
+
+    // Called with each information message before the auto-trader sees it.
+    void OnInformationMessage(unsigned char messageType, unsigned char const* data, std::size_t size);
+
+    long GetEtfPosition() const { return mEtfPosition; }
+    long GetFuturePosition() const { return mFuturePosition; }
+    signed long GetTotalFees() const { return mTotalFees; }
+    unsigned long GetEtfVolumeTraded() const { return mEtfVolumeTraded; }
+    unsigned long GetErrorCount() const { return mErrorCount; }
+    bool IsBreached() const { return mIsBreached; }
+
+    // Cash plus the value of both positions at the most recent prices.
+    signed long GetProfitOrLoss() const;
+
+private:
+    struct Order
+    {
+        Side mSide;
+        Lifespan mLifespan;
+        unsigned long mPrice;
+        unsigned long mVolume;
+        unsigned long mRemainingVolume;
+        signed long mFees;
+    };
+
+    void AmendOrder(const AmendMessage& amend);
+    void CancelOrder(const CancelMessage& cancel);
+    void HedgeOrder(const HedgeMessage& hedge);
+    void InsertOrder(const InsertMessage& insert);
+    void TradePassively(const TradeTicksMessage& ticks);
+
+    bool CheckOrder(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume);
+    void Fill(unsigned long clientOrderId, Order& order, unsigned long price, unsigned long volume, double feeRate);
+    unsigned long GetMarkPrice(Instrument instrument) const;
+
+    void Reply(unsigned char messageType, const ISerialisable& serialisable);
+    void SendError(unsigned long clientOrderId, const std::string& message);
+    void Breach(unsigned long clientOrderId, const std::string& message);
+
+    boost::asio::io_context& mContext;
+    SimulationOptions mOptions;
+    ITimerSource& mTimers;
+
+    // When each message within the message frequency interval was received.
+    std::deque<ITimerSource::Clock::time_point> mMessageTimes;
+
+    std::map<unsigned long, Order> mOrders;
+    unsigned long mLastClientOrderId = 0;
+    unsigned long mActiveVolume = 0;
+
+    // Most recent order book for each instrument, less any volume that has
+    // traded with the auto-trader since.
+    std::array<OrderBookMessage, 2> mBooks = {};
+    std::array<unsigned long, 2> mLastTradedPrices = {};
+
+    long mEtfPosition = 0;
+    long mFuturePosition = 0;
+    signed long mCash = 0;
+    signed long mTotalFees = 0;
+    unsigned long mEtfVolumeTraded = 0;
+    unsigned long mErrorCount = 0;
+    bool mIsBreached = false;
+
+    // Where the auto-trader writes each message it sends.
+    std::array<unsigned char, SIMULATED_MESSAGE_SIZE> mOutbound;
+};
+
+// Replays the information messages recorded in a journal as fast as they
+// can be handled, passing each one to the simulated exchange and then to
+// the auto-trader. Each message is delivered from its own handler so that
+// replies from the simulated exchange are handled in between. The timer
+// source's clock follows the receive times in the journal, starting from
+// the first when the subscription is constructed. Once the journal is done,
+// timers still waiting are run, so nothing the auto-trader deferred is lost.
+class ReplaySubscription : public ISubscription
+{
+public:
+    ReplaySubscription(boost::asio::io_context& context,
+                       const std::string& filename,
+                       SimulatedConnection& exchange,
+                       ReplayTimerSource& timers);
+
+    void AsyncReceive() override;
+
+    unsigned long GetMessageCount() const { return mMessageCount; }
+
+    // Nanoseconds of market data replayed, according to the receive times.
+    std::uint64_t GetReplayedDuration() const { return mLastReceiveTime - mFirstReceiveTime; }
+
+    std::function<void()> Finished;
+
+private:
+    void Step(const std::weak_ptr<ISubscription>& weak_this);
+
+    boost::asio::io_context& mContext;
+    JournalReader mReader;
+    SimulatedConnection& mExchange;
+    ReplayTimerSource& mTimers;
+
+    // The record to replay next, if there is one.
+    JournalRecord mNext;
+    bool mHasNext = false;
+
+    unsigned long mMessageCount = 0;
+    std::uint64_t mFirstReceiveTime = 0;
+    std::uint64_t mLastReceiveTime = 0;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_REPLAY_H
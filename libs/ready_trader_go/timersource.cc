@@ -0,0 +1,53 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <utility>
+
+#include "timersource.h"
+
+namespace ReadyTraderGo {
+
+namespace {
+
+class SteadyTimer : public ITimer
+{
+public:
+    explicit SteadyTimer(boost::asio::io_context& context) : mTimer(context) {}
+
+    void AsyncWaitUntil(std::chrono::steady_clock::time_point when, std::function<void()> handler) override
+    {
+        mTimer.expires_at(when);
+        mTimer.async_wait([handler=std::move(handler)](const boost::system::error_code& error) {
+            // Waits are cancelled by being replaced or by the timer's
+            // destruction, after which the handler must not run.
+            if (error != boost::asio::error::operation_aborted)
+                handler();
+        });
+    }
+
+private:
+    boost::asio::steady_timer mTimer;
+};
+
+}
+
+std::unique_ptr<ITimer> SteadyTimerSource::CreateTimer()
+{
+    return std::make_unique<SteadyTimer>(mContext);
+}
+
+}
@@ -0,0 +1,66 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_TIMERSOURCE_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_TIMERSOURCE_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+namespace ReadyTraderGo {
+
+struct ITimer
+{
+    virtual ~ITimer() = default;
+
+    // Call handler from the event loop once the time source's clock reaches
+    // the given time, replacing any wait that has not finished. The handler
+    // is never called once the timer has been destroyed.
+    virtual void AsyncWaitUntil(std::chrono::steady_clock::time_point when, std::function<void()> handler) = 0;
+};
+
+// The clock, and timers on it, that timing decisions are made with. Live
+// trading uses the steady clock; a replay uses the time recorded in the
+// journal, so that what happens does not depend on how fast it runs.
+struct ITimerSource
+{
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~ITimerSource() = default;
+    virtual Clock::time_point Now() = 0;
+    virtual std::unique_ptr<ITimer> CreateTimer() = 0;
+};
+
+class SteadyTimerSource : public ITimerSource
+{
+public:
+    explicit SteadyTimerSource(boost::asio::io_context& context) : mContext(context) {}
+
+    Clock::time_point Now() override { return Clock::now(); }
+    std::unique_ptr<ITimer> CreateTimer() override;
+
+private:
+    boost::asio::io_context& mContext;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_TIMERSOURCE_H
@@ -28,6 +28,9 @@ constexpr unsigned long MAXIMUM_ASK = 2147483647;
 constexpr unsigned long MINIMUM_BID = 1;
 constexpr std::size_t TOP_LEVEL_COUNT = 5;
 
+// Used to keep data touched by different threads on separate cache lines.
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
 enum class Instrument : unsigned char { FUTURE, ETF };
 enum class Lifespan : unsigned char { FILL_AND_KILL, GOOD_FOR_DAY };
 enum class Side : unsigned char { SELL, BUY };
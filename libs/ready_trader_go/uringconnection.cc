@@ -0,0 +1,604 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <string>
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include "error.h"
+#include "logging.h"
+#include "uringconnection.h"
+
+namespace error = boost::asio::error;
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_URING, "URING")
+
+namespace ReadyTraderGo {
+
+// Only a receive and a write are ever outstanding, so a small ring will do.
+constexpr unsigned int IO_URING_ENTRIES = 16;
+
+// How long the submission queue polling thread spins before sleeping.
+constexpr unsigned int IO_URING_SQ_THREAD_IDLE_MILLISECONDS = 1000;
+
+// Identify the operation each completion belongs to.
+constexpr std::uint64_t RECEIVE_TAG = 1;
+constexpr std::uint64_t WRITE_TAG = 2;
+
+// The outbound ring is registered as fixed buffer zero and the receive
+// buffers as buffer group zero.
+constexpr std::uint16_t SEND_BUFFER_INDEX = 0;
+constexpr std::uint16_t RECEIVE_BUFFER_GROUP = 0;
+
+static_assert((IO_URING_RECEIVE_BUFFER_COUNT & (IO_URING_RECEIVE_BUFFER_COUNT - 1)) == 0,
+              "the number of receive buffers must be a power of two");
+static_assert(IO_URING_RECEIVE_BUFFER_SIZE + EXECUTION_MAXIMUM_MESSAGE_SIZE <= EXECUTION_INBOUND_RING_SIZE,
+              "a receive buffer must always fit in the inbound ring");
+static_assert(sizeof(std::atomic<unsigned int>) == sizeof(unsigned int)
+              && std::atomic<unsigned int>::is_always_lock_free,
+              "ring indices are accessed as lock-free atomics");
+static_assert(sizeof(std::atomic<std::uint16_t>) == sizeof(std::uint16_t)
+              && std::atomic<std::uint16_t>::is_always_lock_free,
+              "the buffer ring tail is accessed as a lock-free atomic");
+
+// The ring indices are shared with the kernel.
+template<typename T>
+static inline T loadAcquire(T const* p)
+{
+    return reinterpret_cast<std::atomic<T> const*>(p)->load(std::memory_order_acquire);
+}
+
+template<typename T>
+static inline void storeRelease(T* p, T value)
+{
+    reinterpret_cast<std::atomic<T>*>(p)->store(value, std::memory_order_release);
+}
+
+static int ioUringSetup(unsigned int entries, io_uring_params* params)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ioUringEnter(int fd, unsigned int toSubmit, unsigned int minComplete, unsigned int flags)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+static int ioUringRegister(int fd, unsigned int opcode, void* arg, unsigned int count)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+static ReadyTraderGoError systemError(const std::string& what)
+{
+    return ReadyTraderGoError(what + ": " + std::strerror(errno));
+}
+
+UringConnection::UringConnection(boost::asio::io_context& context,
+                                 tcp::socket& socket,
+                                 const ConnectionOptions& options)
+    : mContext(context),
+      mOptions(options),
+      mEventDescriptor(context),
+      mInRing(),
+      mSocket(context)
+{
+    try
+    {
+        Setup();
+    }
+    catch (const ReadyTraderGoError&)
+    {
+        Release();
+        throw;
+    }
+
+    // Only take the socket once nothing else can fail.
+    mSocket = std::move(socket);
+    SetName('\'' + std::to_string(mSocket.local_endpoint().port()) + '\'');
+
+    // Completions for writes arrive whether or not anything is being read.
+    if (mOptions.mBusyPoll)
+        boost::asio::post(mContext, [this]() { Poll(); });
+    else
+        WaitForCompletions();
+}
+
+UringConnection::~UringConnection()
+{
+    RLOG(LG_URING, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing, " << mMessagesSent
+                                      << " messages were sent in " << mWrites << " writes with " << mEnterCalls
+                                      << " io_uring_enter calls, outbound ring high-water mark was "
+                                      << mOutRing.GetHighWaterMark() << " of " << EXECUTION_OUTBOUND_RING_SIZE
+                                      << " bytes";
+    Release();
+    if (mSocket.is_open())
+    {
+        mSocket.close();
+    }
+}
+
+void UringConnection::Setup()
+{
+    // Every receive buffer may be filled before any completion is reaped.
+    io_uring_params params = {};
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = 2 * IO_URING_RECEIVE_BUFFER_COUNT;
+    if (mOptions.mIoUringSqPoll)
+    {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = IO_URING_SQ_THREAD_IDLE_MILLISECONDS;
+    }
+
+    mRingFd = ioUringSetup(IO_URING_ENTRIES, &params);
+    if (mRingFd < 0)
+        throw systemError("io_uring_setup failed");
+
+    const unsigned int features = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_FAST_POLL;
+    if ((params.features & features) != features)
+        throw ReadyTraderGoError("io_uring is missing required features");
+
+    // With IORING_FEAT_SINGLE_MMAP both queues share one mapping.
+    mRingsSize = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned int),
+                          params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    void* rings = ::mmap(nullptr, mRingsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mRingFd,
+                         IORING_OFF_SQ_RING);
+    if (rings == MAP_FAILED)
+        throw systemError("failed to map io_uring queues");
+    mRings = rings;
+
+    mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mRingFd,
+                        IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+        throw systemError("failed to map io_uring submission queue entries");
+    mSqes = static_cast<io_uring_sqe*>(sqes);
+
+    auto* base = static_cast<unsigned char*>(mRings);
+    mSqHead = reinterpret_cast<unsigned int*>(base + params.sq_off.head);
+    mSqTail = reinterpret_cast<unsigned int*>(base + params.sq_off.tail);
+    mSqFlags = reinterpret_cast<unsigned int*>(base + params.sq_off.flags);
+    mSqArray = reinterpret_cast<unsigned int*>(base + params.sq_off.array);
+    mSqMask = *reinterpret_cast<unsigned int*>(base + params.sq_off.ring_mask);
+    mSqEntries = params.sq_entries;
+    mCqHead = reinterpret_cast<unsigned int*>(base + params.cq_off.head);
+    mCqTail = reinterpret_cast<unsigned int*>(base + params.cq_off.tail);
+    mCqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+    mCqMask = *reinterpret_cast<unsigned int*>(base + params.cq_off.ring_mask);
+    mSqLocalTail = *mSqTail;
+
+    // Entries are always used in order, so the index array never changes.
+    for (unsigned int i = 0; i < mSqEntries; ++i)
+        mSqArray[i] = i;
+
+    // Writes come straight from the outbound ring, which is pinned once here
+    // rather than for every write.
+    const auto storage = mOutRing.Storage();
+    iovec iov = {const_cast<void*>(storage.data()), storage.size()};
+    if (ioUringRegister(mRingFd, IORING_REGISTER_BUFFERS, &iov, 1) < 0)
+        throw systemError("failed to register the send buffer");
+
+    // The buffer ring and the buffers themselves share one page-aligned
+    // mapping.
+    mBufferRingSize = IO_URING_RECEIVE_BUFFER_COUNT * (sizeof(io_uring_buf) + IO_URING_RECEIVE_BUFFER_SIZE);
+    void* bufferRing = ::mmap(nullptr, mBufferRingSize, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (bufferRing == MAP_FAILED)
+        throw systemError("failed to allocate receive buffers");
+    mBufferRing = static_cast<io_uring_buf_ring*>(bufferRing);
+    mReceiveBuffers = static_cast<unsigned char*>(bufferRing)
+                      + IO_URING_RECEIVE_BUFFER_COUNT * sizeof(io_uring_buf);
+
+    io_uring_buf_reg reg = {};
+    reg.ring_addr = reinterpret_cast<std::uint64_t>(mBufferRing);
+    reg.ring_entries = IO_URING_RECEIVE_BUFFER_COUNT;
+    reg.bgid = RECEIVE_BUFFER_GROUP;
+    if (ioUringRegister(mRingFd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+        throw systemError("failed to register receive buffers");
+
+    for (std::uint16_t i = 0; i < IO_URING_RECEIVE_BUFFER_COUNT; ++i)
+        ProvideBuffer(i);
+    storeRelease(&mBufferRing->tail, mBufferRingTail);
+
+    int eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd < 0)
+        throw systemError("failed to create eventfd");
+    mEventDescriptor.assign(eventFd);
+    if (ioUringRegister(mRingFd, IORING_REGISTER_EVENTFD, &eventFd, 1) < 0)
+        throw systemError("failed to register eventfd");
+
+    // Unlike send, a write cannot be told not to raise SIGPIPE when the
+    // exchange has closed the connection.
+    std::signal(SIGPIPE, SIG_IGN);
+}
+
+void UringConnection::Release()
+{
+    // Closing the ring cancels anything in flight and unregisters the
+    // buffers, so it must happen before they are unmapped.
+    if (mRingFd >= 0)
+    {
+        ::close(mRingFd);
+        mRingFd = -1;
+    }
+    if (mEventDescriptor.is_open())
+    {
+        boost::system::error_code error;
+        mEventDescriptor.close(error);
+    }
+    if (mBufferRing != nullptr)
+    {
+        ::munmap(mBufferRing, mBufferRingSize);
+        mBufferRing = nullptr;
+    }
+    if (mSqes != nullptr)
+    {
+        ::munmap(mSqes, mSqesSize);
+        mSqes = nullptr;
+    }
+    if (mRings != nullptr)
+    {
+        ::munmap(mRings, mRingsSize);
+        mRings = nullptr;
+    }
+}
+
+void UringConnection::ProvideBuffer(std::uint16_t bufferId)
+{
+    // The new tail is published by the caller. The entries are indexed by
+    // hand because in C++ the header's flexible array doesn't start at the
+    // beginning of the ring as it does in C.
+    auto* buffers = reinterpret_cast<io_uring_buf*>(mBufferRing);
+    io_uring_buf& buffer = buffers[mBufferRingTail & (IO_URING_RECEIVE_BUFFER_COUNT - 1)];
+    buffer.addr = reinterpret_cast<std::uint64_t>(mReceiveBuffers + bufferId * IO_URING_RECEIVE_BUFFER_SIZE);
+    buffer.len = IO_URING_RECEIVE_BUFFER_SIZE;
+    buffer.bid = bufferId;
+    ++mBufferRingTail;
+}
+
+io_uring_sqe* UringConnection::NextSqe()
+{
+    if (mSqLocalTail - loadAcquire(mSqHead) >= mSqEntries)
+        throw ReadyTraderGoError("io_uring submission queue overflow");
+    io_uring_sqe* sqe = &mSqes[mSqLocalTail & mSqMask];
+    std::memset(sqe, 0, sizeof(*sqe));
+    ++mSqLocalTail;
+    return sqe;
+}
+
+void UringConnection::Submit()
+{
+    storeRelease(mSqTail, mSqLocalTail);
+
+    unsigned int toSubmit = 0;
+    unsigned int flags = 0;
+    if (mOptions.mIoUringSqPoll)
+    {
+        // The polling thread picks up new entries by itself unless it has
+        // gone to sleep.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if ((loadAcquire(mSqFlags) & IORING_SQ_NEED_WAKEUP) == 0)
+            return;
+        flags = IORING_ENTER_SQ_WAKEUP;
+    }
+    else
+    {
+        toSubmit = mSqLocalTail - loadAcquire(mSqHead);
+    }
+
+    ++mEnterCalls;
+    if (ioUringEnter(mRingFd, toSubmit, 0, flags) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+    {
+        RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " io_uring_enter failed: "
+                                           << std::strerror(errno);
+        throw systemError("io_uring_enter failed");
+    }
+}
+
+void UringConnection::AsyncRead()
+{
+    // One multishot receive serves the life of the connection, being rearmed
+    // only if the kernel ends it.
+    if (!mIsReading)
+    {
+        mIsReading = true;
+        ArmReceive();
+        Submit();
+    }
+}
+
+void UringConnection::ArmReceive()
+{
+    io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = mSocket.native_handle();
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECEIVE_BUFFER_GROUP;
+    sqe->user_data = RECEIVE_TAG;
+}
+
+void UringConnection::WaitForCompletions()
+{
+    mEventDescriptor.async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                                [this](const boost::system::error_code& error) {
+        if (error == error::operation_aborted)
+            return;
+
+        if (error)
+        {
+            RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " wait failed: "
+                                               << error.message();
+            OnDisconnect();
+            return;
+        }
+
+        std::uint64_t count;
+        if (::read(mEventDescriptor.native_handle(), &count, sizeof(count)) < 0 && errno != EAGAIN)
+        {
+            RLOG(LG_URING, LogLevel::LL_WARNING) << std::quoted(mName, '\'') << " eventfd read failed: "
+                                                 << std::strerror(errno);
+        }
+
+        if (ReapCompletions())
+            WaitForCompletions();
+    });
+}
+
+void UringConnection::Poll()
+{
+    if (ReapCompletions())
+        boost::asio::post(mContext, [this]() { Poll(); });
+}
+
+bool UringConnection::ReapCompletions()
+{
+    for (;;)
+    {
+        unsigned int head = *mCqHead;
+        const unsigned int tail = loadAcquire(mCqTail);
+        while (head != tail)
+        {
+            const io_uring_cqe& cqe = mCqes[head & mCqMask];
+            const std::uint64_t tag = cqe.user_data;
+            const int result = cqe.res;
+            const unsigned int flags = cqe.flags;
+
+            // Hand the entry back before its handler runs, since the handler
+            // may submit more work or close the connection.
+            storeRelease(mCqHead, ++head);
+
+            if (tag == RECEIVE_TAG)
+            {
+                if (!ReceiveHandler(result, flags))
+                    return false;
+            }
+            else if (tag == WRITE_TAG)
+            {
+                WriteHandler(result);
+            }
+        }
+
+        // Completions that didn't fit in the queue are held by the kernel
+        // until asked for, and no further event is signalled for them.
+        if ((loadAcquire(mSqFlags) & IORING_SQ_CQ_OVERFLOW) == 0)
+            return true;
+        ++mEnterCalls;
+        ioUringEnter(mRingFd, 0, 0, IORING_ENTER_GETEVENTS);
+    }
+}
+
+bool UringConnection::ReceiveHandler(int result, unsigned int flags)
+{
+    if (result <= 0)
+    {
+        if (result == 0)
+        {
+            RLOG(LG_URING, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " remote disconnect";
+        }
+        else if (result == -EINTR || result == -EAGAIN || result == -ENOBUFS)
+        {
+            RLOG(LG_URING, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " receive interrupted: "
+                                               << std::strerror(-result);
+            if ((flags & IORING_CQE_F_MORE) == 0)
+            {
+                ArmReceive();
+                Submit();
+            }
+            return true;
+        }
+        else
+        {
+            RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " receive error: "
+                                               << std::strerror(-result);
+        }
+        OnDisconnect();
+        return false;
+    }
+
+    const auto size = static_cast<std::size_t>(result);
+    const auto bufferId = static_cast<std::uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+    RLOG(LG_URING, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " received " << size
+                                       << " bytes in buffer " << bufferId;
+
+    // Copy into the inbound ring, which is never more than a partial message
+    // full at this point, and give the buffer straight back.
+    unsigned char const* data = mReceiveBuffers + bufferId * IO_URING_RECEIVE_BUFFER_SIZE;
+    const auto space = mInRing.PrepareReceive();
+    const std::size_t first = std::min(size, space[0].size());
+    std::memcpy(space[0].data(), data, first);
+    std::memcpy(space[1].data(), data + first, size - first);
+    mInRing.CommitReceive(size);
+    ProvideBuffer(bufferId);
+    storeRelease(&mBufferRing->tail, mBufferRingTail);
+
+    if (mOptions.mQuickAck)
+    {
+        // Linux clears this option as soon as it has been acted on.
+        const int one = 1;
+        ::setsockopt(mSocket.native_handle(), IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one));
+    }
+
+    std::size_t invalidLength = 0;
+    const bool valid = dispatchMessages(mInRing, [this](unsigned char messageType, unsigned char const* message,
+                                                        std::size_t messageLength) {
+        RLOG(LG_URING, LogLevel::LL_DEBUG) << std::quoted(mName, '\'')
+                                           << " received message with type=" << static_cast<int>(messageType)
+                                           << " and size=" << messageLength;
+        OnMessageReceipt(messageType, message + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE);
+    }, invalidLength);
+    if (!valid)
+    {
+        RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'')
+                                           << " received message with invalid size=" << invalidLength;
+        OnDisconnect();
+        return false;
+    }
+
+    if ((flags & IORING_CQE_F_MORE) == 0)
+    {
+        ArmReceive();
+        Submit();
+    }
+    return true;
+}
+
+void UringConnection::Send()
+{
+    // Short writes are finished by WriteHandler, so only the first block of
+    // a wrapped ring goes in each write.
+    mIsSending = true;
+    const auto data = mOutRing.Data();
+    io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = mSocket.native_handle();
+    sqe->addr = reinterpret_cast<std::uint64_t>(data[0].data());
+    sqe->len = static_cast<std::uint32_t>(data[0].size());
+    sqe->buf_index = SEND_BUFFER_INDEX;
+    sqe->user_data = WRITE_TAG;
+    ++mWrites;
+    Submit();
+}
+
+void UringConnection::Send(SendMode mode)
+{
+    if (mode == SendMode::ASAP)
+    {
+        Send();
+    }
+    else if (!mIsSendPosted)
+    {
+        boost::asio::post(mContext, [this] {
+            mIsSendPosted = false;
+            if (!mIsSending && !mOutRing.Empty())
+            {
+                Send();
+            }
+        });
+        mIsSendPosted = true;
+    }
+}
+
+unsigned char* UringConnection::Prepare(std::size_t size)
+{
+    unsigned char* data = mOutRing.Prepare(size);
+    if (data == nullptr)
+    {
+        RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " cannot queue message with size="
+                                           << size << ", " << mOutRing.Size() << " bytes are waiting to be sent";
+        throw ReadyTraderGoError("outbound message ring overflow");
+    }
+    return data;
+}
+
+void UringConnection::Commit(std::size_t size, SendMode mode)
+{
+    mOutRing.Commit(size);
+    ++mMessagesSent;
+    if (!mIsSending && mBatchDepth == 0)
+    {
+        Send(mode);
+    }
+}
+
+void UringConnection::BeginBatch()
+{
+    ++mBatchDepth;
+}
+
+void UringConnection::Flush()
+{
+    if (mBatchDepth > 0 && --mBatchDepth == 0 && !mIsSending && !mOutRing.Empty())
+    {
+        // Everything queued during the batch goes in a single write.
+        Send();
+    }
+}
+
+void UringConnection::WriteHandler(int result)
+{
+    if (result < 0)
+    {
+        if (result != -EINTR && result != -EAGAIN)
+        {
+            RLOG(LG_URING, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " send failed: "
+                                               << std::strerror(-result);
+            throw ReadyTraderGoError(std::string("send failed: ") + std::strerror(-result));
+        }
+        RLOG(LG_URING, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " send interrupted: "
+                                           << std::strerror(-result);
+    }
+    else
+    {
+        RLOG(LG_URING, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " sent " << result << " bytes";
+        mOutRing.Consume(static_cast<std::size_t>(result));
+    }
+
+    if (!mOutRing.Empty())
+    {
+        Send();
+    }
+    else
+    {
+        mIsSending = false;
+    }
+}
+
+}
+
+#endif
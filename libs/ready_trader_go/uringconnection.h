@@ -0,0 +1,131 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_URINGCONNECTION_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_URINGCONNECTION_H
+
+#ifdef __linux__
+
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include "bytering.h"
+#include "connectivity.h"
+#include "connectivitytypes.h"
+
+struct io_uring_buf_ring;
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+namespace ReadyTraderGo {
+
+// Number of buffers, and the size of each, that the kernel may fill with
+// received data before the connection hands them back.
+constexpr std::size_t IO_URING_RECEIVE_BUFFER_COUNT = 64;
+constexpr std::size_t IO_URING_RECEIVE_BUFFER_SIZE = 1024;
+
+// An execution connection driven by io_uring. The outbound ring is
+// registered with the kernel and written with fixed-buffer writes, and a
+// single multishot receive delivers incoming data into kernel-selected
+// buffers, so no receive needs to be resubmitted. Completions are reaped
+// from the completion queue when an eventfd registered with the ring
+// becomes readable, or by polling when busy polling.
+class UringConnection : public IConnection
+{
+public:
+    // Throws ReadyTraderGoError if the kernel lacks any of the features
+    // needed, in which case the socket is left with the caller.
+    UringConnection(boost::asio::io_context& context,
+                    tcp::socket& socket,
+                    const ConnectionOptions& options);
+    ~UringConnection() override;
+    void AsyncRead() override;
+    unsigned char* Prepare(std::size_t size) override;
+    void Commit(std::size_t size, SendMode mode) override;
+    void BeginBatch() override;
+    void Flush() override;
+
+private:
+    void Setup();
+    void Release();
+    void ProvideBuffer(std::uint16_t bufferId);
+
+    io_uring_sqe* NextSqe();
+    void Submit();
+    void ArmReceive();
+    void Send();
+    void Send(SendMode mode);
+
+    void WaitForCompletions();
+    void Poll();
+    bool ReapCompletions();
+    bool ReceiveHandler(int result, unsigned int flags);
+    void WriteHandler(int result);
+
+    boost::asio::io_context& mContext;
+    ConnectionOptions mOptions;
+
+    // The io_uring instance and its shared memory.
+    int mRingFd = -1;
+    void* mRings = nullptr;
+    std::size_t mRingsSize = 0;
+    io_uring_sqe* mSqes = nullptr;
+    std::size_t mSqesSize = 0;
+    unsigned int* mSqHead = nullptr;
+    unsigned int* mSqTail = nullptr;
+    unsigned int* mSqFlags = nullptr;
+    unsigned int* mSqArray = nullptr;
+    unsigned int mSqMask = 0;
+    unsigned int mSqEntries = 0;
+    unsigned int* mCqHead = nullptr;
+    unsigned int* mCqTail = nullptr;
+    io_uring_cqe* mCqes = nullptr;
+    unsigned int mCqMask = 0;
+    unsigned int mSqLocalTail = 0;
+
+    // Buffers provided to the kernel for the multishot receive.
+    io_uring_buf_ring* mBufferRing = nullptr;
+    std::size_t mBufferRingSize = 0;
+    std::uint16_t mBufferRingTail = 0;
+    unsigned char* mReceiveBuffers = nullptr;
+
+    // Signalled by the kernel whenever a completion is posted.
+    boost::asio::posix::stream_descriptor mEventDescriptor;
+
+    // Counts showing how many system calls were saved.
+    unsigned long mMessagesSent = 0;
+    unsigned long mWrites = 0;
+    unsigned long mEnterCalls = 0;
+
+    ByteRing<EXECUTION_INBOUND_RING_SIZE, EXECUTION_MAXIMUM_MESSAGE_SIZE> mInRing;
+    ByteRing<EXECUTION_OUTBOUND_RING_SIZE, EXECUTION_MAXIMUM_MESSAGE_SIZE> mOutRing;
+    bool mIsReading = false;
+    bool mIsSending = false;
+    bool mIsSendPosted = false;
+    unsigned int mBatchDepth = 0;
+    tcp::socket mSocket;
+};
+
+}
+
+#endif
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_URINGCONNECTION_H
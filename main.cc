@@ -21,6 +21,7 @@
 #include <ready_trader_go/application.h>
 #include <ready_trader_go/autotraderapphandler.h>
 #include <ready_trader_go/error.h>
+#include <ready_trader_go/timersource.h>
 
 #include "autotrader.h"
 
@@ -29,7 +30,8 @@ int main(int argc, char* argv[])
     try
     {
         ReadyTraderGo::Application app;
-        AutoTrader trader{app.GetContext()};
+        ReadyTraderGo::SteadyTimerSource timers{app.GetContext()};
+        AutoTrader trader{app.GetContext(), timers};
         ReadyTraderGo::AutoTraderAppHandler appHandler{app, trader};
         app.Run(argc, argv);
     }
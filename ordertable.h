@@ -0,0 +1,138 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_ORDERTABLE_H
+#define CPPREADY_TRADER_GO_ORDERTABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <ready_trader_go/types.h>
+
+// The trader's active orders, held in a fixed number of slots. The exchange
+// allows at most ten active orders, so the whole table is a few cache lines
+// and finding an order by scanning the slots is cheaper than hashing its id.
+class OrderTable
+{
+public:
+    static constexpr std::size_t CAPACITY = 16;
+
+    enum class State : unsigned char { FREE, LIVE, CANCELLING };
+
+    // Everything known about one order, packed so that a slot never
+    // straddles a cache line.
+    struct alignas(32) Order
+    {
+        std::uint32_t mClientOrderId = 0;
+        std::uint32_t mPrice = 0;
+        std::uint32_t mSequenceNumber = 0;
+        std::uint32_t mRemainingVolume = 0;
+        ReadyTraderGo::Side mSide = ReadyTraderGo::Side::SELL;
+        State mState = State::FREE;
+    };
+
+    // Track a new order. Returns nullptr if every slot is taken.
+    Order* Insert(unsigned long clientOrderId,
+                  ReadyTraderGo::Side side,
+                  unsigned long price,
+                  unsigned long volume,
+                  unsigned long sequenceNumber);
+
+    // Return the order with the given id, or nullptr if it isn't tracked.
+    Order* Find(unsigned long clientOrderId);
+    void Remove(unsigned long clientOrderId);
+
+    bool Full() const { return mSize == CAPACITY; }
+    std::size_t Size() const { return mSize; }
+
+    // The volume yet to trade across the orders on one side.
+    unsigned long RemainingVolume(ReadyTraderGo::Side side) const;
+
+    // Call f with each tracked order on one side.
+    template<typename F>
+    void ForEach(ReadyTraderGo::Side side, F&& f);
+
+private:
+    std::array<Order, CAPACITY> mOrders;
+    std::size_t mSize = 0;
+};
+
+inline OrderTable::Order* OrderTable::Insert(unsigned long clientOrderId,
+                                             ReadyTraderGo::Side side,
+                                             unsigned long price,
+                                             unsigned long volume,
+                                             unsigned long sequenceNumber)
+{
+    for (auto& order : mOrders)
+    {
+        if (order.mState == State::FREE)
+        {
+            order.mClientOrderId = clientOrderId;
+            order.mPrice = price;
+            order.mSequenceNumber = sequenceNumber;
+            order.mRemainingVolume = volume;
+            order.mSide = side;
+            order.mState = State::LIVE;
+            ++mSize;
+            return &order;
+        }
+    }
+    return nullptr;
+}
+
+inline OrderTable::Order* OrderTable::Find(unsigned long clientOrderId)
+{
+    for (auto& order : mOrders)
+    {
+        if (order.mState != State::FREE && order.mClientOrderId == clientOrderId)
+            return &order;
+    }
+    return nullptr;
+}
+
+inline void OrderTable::Remove(unsigned long clientOrderId)
+{
+    if (Order* order = Find(clientOrderId))
+    {
+        order->mState = State::FREE;
+        --mSize;
+    }
+}
+
+inline unsigned long OrderTable::RemainingVolume(ReadyTraderGo::Side side) const
+{
+    unsigned long volume = 0;
+    for (const auto& order : mOrders)
+    {
+        if (order.mState != State::FREE && order.mSide == side)
+            volume += order.mRemainingVolume;
+    }
+    return volume;
+}
+
+template<typename F>
+void OrderTable::ForEach(ReadyTraderGo::Side side, F&& f)
+{
+    for (auto& order : mOrders)
+    {
+        if (order.mState != State::FREE && order.mSide == side)
+            f(order);
+    }
+}
+
+#endif //CPPREADY_TRADER_GO_ORDERTABLE_H
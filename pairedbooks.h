@@ -0,0 +1,99 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_PAIREDBOOKS_H
+#define CPPREADY_TRADER_GO_PAIREDBOOKS_H
+
+#include <array>
+#include <cstddef>
+
+#include <ready_trader_go/types.h>
+
+// The top of the ETF and future order books for recent sequence numbers,
+// so that the two updates carrying the same sequence number can be paired.
+// Slots are indexed by the low bits of the sequence number and reused once
+// the sequence number moves on, so entries that never pair are evicted
+// rather than kept forever.
+class PairedBooks
+{
+public:
+    static constexpr std::size_t CAPACITY = 16;
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+    struct TopOfBook
+    {
+        unsigned long mMid = 0;
+        unsigned long mBestAskPrice = 0;
+        unsigned long mBestAskVolume = 0;
+        unsigned long mBestBidPrice = 0;
+        unsigned long mBestBidVolume = 0;
+    };
+
+    // Return the instrument's top of book for the sequence number, or
+    // nullptr if it hasn't been stored.
+    const TopOfBook* Find(ReadyTraderGo::Instrument instrument, unsigned long sequenceNumber) const;
+
+    void Store(ReadyTraderGo::Instrument instrument, unsigned long sequenceNumber, const TopOfBook& top);
+    void Erase(unsigned long sequenceNumber);
+
+private:
+    struct Slot
+    {
+        unsigned long mSequenceNumber = 0;
+        std::array<bool, 2> mPresent = {};
+        std::array<TopOfBook, 2> mBooks;
+    };
+
+    Slot& SlotFor(unsigned long sequenceNumber) { return mSlots[sequenceNumber & (CAPACITY - 1)]; }
+    const Slot& SlotFor(unsigned long sequenceNumber) const { return mSlots[sequenceNumber & (CAPACITY - 1)]; }
+
+    std::array<Slot, CAPACITY> mSlots;
+};
+
+inline const PairedBooks::TopOfBook* PairedBooks::Find(ReadyTraderGo::Instrument instrument,
+                                                       unsigned long sequenceNumber) const
+{
+    const Slot& slot = SlotFor(sequenceNumber);
+    const auto index = static_cast<std::size_t>(instrument);
+    if (slot.mSequenceNumber != sequenceNumber || !slot.mPresent[index])
+        return nullptr;
+    return &slot.mBooks[index];
+}
+
+inline void PairedBooks::Store(ReadyTraderGo::Instrument instrument,
+                               unsigned long sequenceNumber,
+                               const TopOfBook& top)
+{
+    Slot& slot = SlotFor(sequenceNumber);
+    if (slot.mSequenceNumber != sequenceNumber)
+    {
+        slot.mSequenceNumber = sequenceNumber;
+        slot.mPresent = {};
+    }
+    const auto index = static_cast<std::size_t>(instrument);
+    slot.mPresent[index] = true;
+    slot.mBooks[index] = top;
+}
+
+inline void PairedBooks::Erase(unsigned long sequenceNumber)
+{
+    Slot& slot = SlotFor(sequenceNumber);
+    if (slot.mSequenceNumber == sequenceNumber)
+        slot.mPresent = {};
+}
+
+#endif //CPPREADY_TRADER_GO_PAIREDBOOKS_H
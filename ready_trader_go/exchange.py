@@ -28,7 +28,7 @@ from .limiter import FrequencyLimiterFactory
 from .market_events import MarketEventsReader
 from .match_events import MatchEvents, MatchEventsWriter
 from .order_book import OrderBook
-from .pubsub import PublisherFactory
+from .pubsub import BUFFER_SIZE, FRAME_SIZE, PublisherFactory
 from .score_board import ScoreBoardWriter
 from .timer import Timer
 from .types import Instrument
@@ -111,7 +111,9 @@ def setup(app: Application) -> Controller:
     limiter_factory = FrequencyLimiterFactory(limits["MessageFrequencyInterval"] / engine["Speed"],
                                               limits["MessageFrequencyLimit"])
     exec_server = ExecutionServer(exec_["Host"], exec_["Port"], competitor_manager, limiter_factory)
-    info_publisher = InformationPublisher(app.event_loop, PublisherFactory(info["Type"], info["Name"]),
+    pub_factory = PublisherFactory(info["Type"], info["Name"], info.get("BufferSize", BUFFER_SIZE),
+                                   info.get("FrameSize", FRAME_SIZE))
+    info_publisher = InformationPublisher(app.event_loop, pub_factory,
                                           (future_book, etf_book), tick_timer)
 
     market_timer = Timer(engine["MarketEventInterval"], engine["Speed"])
@@ -18,14 +18,17 @@
 import asyncio
 import mmap
 import os
+import socket
 import struct
 
+from multiprocessing import resource_tracker, shared_memory
+
 from typing import Coroutine, Optional, Tuple, Union
 
 BUFFER_SIZE = 8192
 FRAME_HEADER_SIZE = 8
 FRAME_SIZE = 128
-MAXIMUM_PAYLOAD_LENGTH = FRAME_SIZE - FRAME_HEADER_SIZE
+FRAME_GENERATION_LIMIT = 0xFFFFFF
 
 
 class Publisher(asyncio.WriteTransport):
@@ -35,16 +38,22 @@ class Publisher(asyncio.WriteTransport):
     memory blocks. There must be an interval between writes to permit
     subscribers to read the data before it is overwritten.
     """
-    __slots__ = ("__pack_into", "_buffer", "_closed", "_pos")
+    __slots__ = ("__pack_into", "__pack_spinlock", "_buffer", "_closed", "_frame_size", "_generation", "_mask",
+                 "_pos")
 
-    def __init__(self, buffer: Union[mmap.mmap, memoryview], protocol: asyncio.BaseProtocol):
+    def __init__(self, buffer: Union[mmap.mmap, memoryview], protocol: asyncio.BaseProtocol,
+                 frame_size: int = FRAME_SIZE):
         super().__init__()
         self._buffer: Optional[Union[mmap.mmap, memoryview]] = buffer
         self._closed: bool = False
+        self._frame_size: int = frame_size
+        self._mask: int = len(buffer) - 1
         self._pos: int = 0
+        self._generation: int = 1
         asyncio.get_event_loop().call_soon(protocol.connection_made, self)
 
         self.__pack_into = struct.Struct("!I").pack_into
+        self.__pack_spinlock = struct.Struct("<I").pack_into
 
     def __del__(self):
         if not self._closed:
@@ -64,29 +73,35 @@ class Publisher(asyncio.WriteTransport):
 
     def write(self, data: Union[bytearray, bytes, memoryview]) -> None:
         """Publish the provided data."""
-        if len(data) > MAXIMUM_PAYLOAD_LENGTH:
+        if len(data) > self._frame_size - FRAME_HEADER_SIZE:
             raise ValueError("payload is longer than maximum payload length")
 
         if self._closed:
             return
 
         # Each frame contains a spinlock (4 bytes), payload length (4 bytes)
-        # and payload (up to 120 bytes).
+        # and payload (up to frame size less 8 bytes). The spinlock's low byte
+        # is the ready flag and its upper bytes are the lap of the ring the
+        # frame was written on, so that readers can tell when they have been
+        # lapped.
         pos = self._pos
+        generation = self._generation
         self.__pack_into(self._buffer, pos + 4, len(data))
         start: int = pos + FRAME_HEADER_SIZE
         self._buffer[start:start + len(data)] = bytes(data)
-        self._pos = (pos + FRAME_SIZE) & (BUFFER_SIZE - 1)
-        self._buffer[self._pos] = 0
-        self._buffer[pos] = 1
+        self._pos = (pos + self._frame_size) & self._mask
+        if self._pos == 0:
+            self._generation = generation % FRAME_GENERATION_LIMIT + 1
+        self.__pack_spinlock(self._buffer, self._pos, 0)
+        self.__pack_spinlock(self._buffer, pos, 1 | generation << 8)
 
 
 class MmapPublisher(Publisher):
     """A publisher based on a memory mapped file."""
     __slots__ = ("__fileno",)
 
-    def __init__(self, fileno: int, mm: mmap.mmap, protocol: asyncio.BaseProtocol):
-        super().__init__(mm, protocol)
+    def __init__(self, fileno: int, mm: mmap.mmap, protocol: asyncio.BaseProtocol, frame_size: int = FRAME_SIZE):
+        super().__init__(mm, protocol, frame_size)
         self.__fileno: Optional[int] = fileno
 
     def close(self) -> None:
@@ -100,6 +115,64 @@ class MmapPublisher(Publisher):
             self.__fileno = None
 
 
+class ShmPublisher(Publisher):
+    """A publisher based on a POSIX shared memory block."""
+    __slots__ = ("__shm",)
+
+    def __init__(self, shm: shared_memory.SharedMemory, buffer_size: int, protocol: asyncio.BaseProtocol,
+                 frame_size: int = FRAME_SIZE):
+        super().__init__(shm.buf[:buffer_size], protocol, frame_size)
+        self.__shm: Optional[shared_memory.SharedMemory] = shm
+
+    def close(self) -> None:
+        """Close the publisher and remove the shared memory block."""
+        super().close()
+        if self._buffer:
+            self._buffer.release()
+            self._buffer = None
+        if self.__shm:
+            self.__shm.close()
+            self.__shm.unlink()
+            self.__shm = None
+
+
+class UdpPublisher(asyncio.WriteTransport):
+    """A publisher that sends each message as a datagram to a multicast group
+    on the loopback interface."""
+    __slots__ = ("_closed", "_group", "_socket")
+
+    def __init__(self, group: Tuple[str, int], protocol: asyncio.BaseProtocol):
+        super().__init__()
+        self._closed: bool = False
+        self._group: Tuple[str, int] = group
+        self._socket: Optional[socket.socket] = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self._socket.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_IF, socket.inet_aton("127.0.0.1"))
+        self._socket.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+        self._socket.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 0)
+        self._socket.setblocking(False)
+        asyncio.get_event_loop().call_soon(protocol.connection_made, self)
+
+    def abort(self) -> None:
+        """Close the publisher immediately."""
+        self.close()
+
+    def can_write_eof(self) -> bool:
+        """Return False. Publisher's don't support writing EOF."""
+        return False
+
+    def close(self) -> None:
+        """Close the publisher."""
+        self._closed = True
+        if self._socket:
+            self._socket.close()
+            self._socket = None
+
+    def write(self, data: Union[bytearray, bytes, memoryview]) -> None:
+        """Publish the provided data."""
+        if not self._closed:
+            self._socket.sendto(data, self._group)
+
+
 class Subscriber(asyncio.DatagramTransport):
     """Subscriber side of a datagram transport based on shared memory.
 
@@ -111,18 +184,18 @@ class Subscriber(asyncio.DatagramTransport):
     __slots__ = ("_task", "_closed", "_protocol")
 
     def __init__(self, buffer: Union[mmap.mmap, memoryview], from_addr: Tuple[str, int],
-                 protocol: asyncio.DatagramProtocol):
+                 protocol: asyncio.DatagramProtocol, frame_size: int = FRAME_SIZE):
         super().__init__()
         self._closed: bool = False
         self._protocol: asyncio.DatagramProtocol = protocol
 
-        coro: Coroutine = self._subscribe_worker(buffer, from_addr, protocol)
+        coro: Coroutine = self._subscribe_worker(buffer, from_addr, protocol, frame_size)
         self._task: asyncio.Task = asyncio.ensure_future(coro)
 
     async def _subscribe_worker(self, buffer: Union[mmap.mmap, memoryview],
                                 from_addr: Tuple[str, int],
-                                protocol: asyncio.DatagramProtocol) -> None:
-        mask: int = BUFFER_SIZE - 1
+                                protocol: asyncio.DatagramProtocol, frame_size: int) -> None:
+        mask: int = len(buffer) - 1
         unpack_from = struct.Struct("!I").unpack_from
         protocol.connection_made(self)
 
@@ -134,7 +207,7 @@ class Subscriber(asyncio.DatagramTransport):
                 length, = unpack_from(buffer, pos + 4)
                 start: int = pos + FRAME_HEADER_SIZE
                 protocol.datagram_received(buffer[start:start + length], from_addr)
-                pos = (pos + FRAME_SIZE) & mask
+                pos = (pos + frame_size) & mask
         except asyncio.CancelledError:
             self._protocol.connection_lost(None)
         except Exception as e:
@@ -169,8 +242,8 @@ class MmapSubscriber(Subscriber):
     __slots__ = ("__fileno", "__mmap")
 
     def __init__(self, fileno: int, buffer: mmap.mmap, from_addr: Tuple[str, int],
-                 protocol: Optional[asyncio.DatagramProtocol] = None):
-        super().__init__(buffer, from_addr, protocol)
+                 protocol: Optional[asyncio.DatagramProtocol] = None, frame_size: int = FRAME_SIZE):
+        super().__init__(buffer, from_addr, protocol, frame_size)
         self.__fileno: Optional[int] = fileno
         self.__mmap: Optional[mmap.mmap] = buffer
         self._task.add_done_callback(lambda _: self.__close_mmap())
@@ -187,13 +260,56 @@ class MmapSubscriber(Subscriber):
             self.__fileno = None
 
 
+class ShmSubscriber(Subscriber):
+    """A subscriber based on a POSIX shared memory block."""
+    __slots__ = ("__buffer", "__shm")
+
+    def __init__(self, shm: shared_memory.SharedMemory, buffer_size: int, from_addr: Tuple[str, int],
+                 protocol: Optional[asyncio.DatagramProtocol] = None, frame_size: int = FRAME_SIZE):
+        buffer = shm.buf[:buffer_size]
+        super().__init__(buffer, from_addr, protocol, frame_size)
+        self.__buffer: Optional[memoryview] = buffer
+        self.__shm: Optional[shared_memory.SharedMemory] = shm
+        self._task.add_done_callback(lambda _: self.__close_shm())
+
+    def __del__(self):
+        self.__close_shm()
+
+    def __close_shm(self):
+        if self.__buffer:
+            self.__buffer.release()
+            self.__buffer = None
+        if self.__shm:
+            self.__shm.close()
+            self.__shm = None
+
+
+def _validate_geometry(buffer_size: int, frame_size: int) -> None:
+    if buffer_size <= 0 or buffer_size & (buffer_size - 1):
+        raise ValueError("buffer size must be a power of two")
+    if frame_size <= FRAME_HEADER_SIZE or frame_size & (frame_size - 1) or frame_size > buffer_size:
+        raise ValueError("frame size must be a power of two no larger than the buffer size")
+
+
+def _parse_group(name: str) -> Tuple[str, int]:
+    address, _, port = name.rpartition(":")
+    if not address or not port.isdigit() or not 0 < int(port) < 65536:
+        raise ValueError("multicast group should be of the form 'address:port'")
+    return address, int(port)
+
+
 class PublisherFactory:
     """A factory class for Publisher instances."""
-    def __init__(self, typ: str, name: str):
-        if typ not in ("mmap", "shm"):
-            raise ValueError("type must be either 'mmap' or 'shm'")
+    def __init__(self, typ: str, name: str, buffer_size: int = BUFFER_SIZE, frame_size: int = FRAME_SIZE):
+        if typ not in ("mmap", "shm", "udp"):
+            raise ValueError("type must be one of 'mmap', 'shm' or 'udp'")
+        if typ == "udp":
+            _parse_group(name)
+        _validate_geometry(buffer_size, frame_size)
         self.__typ: str = typ
         self.__name: str = name
+        self.__buffer_size: int = buffer_size
+        self.__frame_size: int = frame_size
 
     @property
     def name(self):
@@ -205,23 +321,38 @@ class PublisherFactory:
         """Return the type for this publisher factory."""
         return self.__typ
 
-    def create(self, protocol: asyncio.BaseProtocol) -> Publisher:
+    def create(self, protocol: asyncio.BaseProtocol) -> asyncio.WriteTransport:
         """Create a new Publisher instance."""
+        if self.__typ == "udp":
+            return UdpPublisher(_parse_group(self.__name), protocol)
         if self.__typ == "mmap":
             fileno = os.open(self.__name, os.O_CREAT | os.O_RDWR)
-            os.write(fileno, b"\x00" * BUFFER_SIZE)
-            buffer = mmap.mmap(fileno, BUFFER_SIZE, access=mmap.ACCESS_WRITE)
-            return MmapPublisher(fileno, buffer, protocol)
-        raise RuntimeError("PublisherFactory type was not 'mmap'")
+            os.write(fileno, b"\x00" * self.__buffer_size)
+            buffer = mmap.mmap(fileno, self.__buffer_size, access=mmap.ACCESS_WRITE)
+            return MmapPublisher(fileno, buffer, protocol, self.__frame_size)
+        if self.__typ == "shm":
+            try:
+                shm = shared_memory.SharedMemory(self.__name, create=True, size=self.__buffer_size)
+            except FileExistsError:
+                # Left behind by a previous run that didn't shut down cleanly.
+                stale = shared_memory.SharedMemory(self.__name)
+                stale.close()
+                stale.unlink()
+                shm = shared_memory.SharedMemory(self.__name, create=True, size=self.__buffer_size)
+            return ShmPublisher(shm, self.__buffer_size, protocol, self.__frame_size)
+        raise RuntimeError("PublisherFactory type was not 'mmap', 'shm' or 'udp'")
 
 
 class SubscriberFactory:
     """A factory class for Subscribers."""
-    def __init__(self, typ: str, name: str):
+    def __init__(self, typ: str, name: str, buffer_size: int = BUFFER_SIZE, frame_size: int = FRAME_SIZE):
         if typ not in ("mmap", "shm"):
             raise ValueError("type must be either 'mmap' or 'shm'")
+        _validate_geometry(buffer_size, frame_size)
         self.__typ: str = typ
         self.__name: str = name
+        self.__buffer_size: int = buffer_size
+        self.__frame_size: int = frame_size
 
     @property
     def name(self):
@@ -237,6 +368,12 @@ class SubscriberFactory:
         """Return a new Subscriber instance."""
         if self.__typ == "mmap":
             fileno = os.open(self.__name, os.O_RDONLY)
-            mm = mmap.mmap(fileno, BUFFER_SIZE, access=mmap.ACCESS_READ)
-            return MmapSubscriber(fileno, mm, (self.__name, fileno), protocol)
-        raise RuntimeError("SubscriberFactory type was not 'mmap'")
+            mm = mmap.mmap(fileno, self.__buffer_size, access=mmap.ACCESS_READ)
+            return MmapSubscriber(fileno, mm, (self.__name, fileno), protocol, self.__frame_size)
+        if self.__typ == "shm":
+            shm = shared_memory.SharedMemory(self.__name)
+            # The publisher owns the block, so don't let the resource tracker
+            # remove it when this process exits.
+            resource_tracker.unregister(shm._name, "shared_memory")
+            return ShmSubscriber(shm, self.__buffer_size, (self.__name, 0), protocol, self.__frame_size)
+        raise RuntimeError("SubscriberFactory type was not 'mmap' or 'shm'")
@@ -26,7 +26,7 @@ from typing import Any, Dict
 
 from .application import Application
 from .base_auto_trader import BaseAutoTrader
-from .pubsub import SubscriberFactory
+from .pubsub import BUFFER_SIZE, FRAME_SIZE, SubscriberFactory
 
 
 # From Python 3.8, the proactor event loop is used by default on Windows
@@ -90,7 +90,8 @@ async def __start_autotrader(auto_trader: BaseAutoTrader, config: Dict[str, Any]
         return
 
     info = config["Information"]
-    sub_factory = SubscriberFactory(info["Type"], info["Name"])
+    sub_factory = SubscriberFactory(info["Type"], info["Name"], info.get("BufferSize", BUFFER_SIZE),
+                                    info.get("FrameSize", FRAME_SIZE))
     sub_factory.create(auto_trader)
 
 
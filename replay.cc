@@ -0,0 +1,90 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/log/core.hpp>
+
+#include <ready_trader_go/error.h>
+#include <ready_trader_go/replay.h>
+
+#include "autotrader.h"
+
+// Replay a journal recorded by the autotrader (see Information.Journal)
+// through the auto-trader as fast as possible, with a simulated exchange in
+// place of the real one, and report how the auto-trader fared.
+int main(int argc, char* argv[])
+{
+    const bool logging = argc == 3 && std::strcmp(argv[1], "--log") == 0;
+    if (argc != 2 && !logging)
+    {
+        std::cerr << "usage: " << argv[0] << " [--log] JOURNAL" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Without --log, records are discarded rather than written to the console.
+    boost::log::core::get()->set_logging_enabled(logging);
+
+    try
+    {
+        boost::asio::io_context context;
+        ReadyTraderGo::ReplayTimerSource timers;
+
+        auto connection = std::make_unique<ReadyTraderGo::SimulatedConnection>(context,
+                                                                               ReadyTraderGo::SimulationOptions(),
+                                                                               timers);
+        ReadyTraderGo::SimulatedConnection& exchange = *connection;
+
+        // Constructing the subscription starts the clock at the journal's
+        // first message, which the auto-trader takes as its start time.
+        auto replay = std::make_shared<ReadyTraderGo::ReplaySubscription>(context, argv[argc - 1], exchange,
+                                                                          timers);
+        replay->Finished = [&context] { context.stop(); };
+
+        AutoTrader trader{context, timers};
+        trader.SetLoginDetails("replay", "replay");
+        trader.SetExecutionConnection(std::move(connection));
+
+        const auto start = std::chrono::steady_clock::now();
+        trader.SetInformationSubscription(replay);
+        context.run();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "replayed " << replay->GetMessageCount() << " messages covering "
+                  << replay->GetReplayedDuration() / 1000000 << " ms in "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() << " us\n"
+                  << "etf_position=" << exchange.GetEtfPosition()
+                  << " future_position=" << exchange.GetFuturePosition()
+                  << " etf_volume_traded=" << exchange.GetEtfVolumeTraded()
+                  << " total_fees=" << exchange.GetTotalFees()
+                  << " profit_or_loss=" << exchange.GetProfitOrLoss()
+                  << " errors=" << exchange.GetErrorCount()
+                  << (exchange.IsBreached() ? " (disconnected for breaching a limit)" : "") << std::endl;
+    }
+    catch (const ReadyTraderGo::ReadyTraderGoError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,231 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <ready_trader_go/ratelimiter.h>
+#include <ready_trader_go/replay.h>
+#include <ready_trader_go/types.h>
+
+#include "actionscheduler.h"
+
+using namespace ReadyTraderGo;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t LIMIT = 4;
+constexpr std::size_t QUOTE_RESERVE = 1;
+
+// Records what the scheduler sends, one string per action.
+struct Sink
+{
+    void execute_hedge(Side side, unsigned long volume)
+    {
+        mSent.push_back(std::string("hedge ") + (side == Side::BUY ? "buy " : "sell ") + std::to_string(volume));
+    }
+
+    void execute_cancel(unsigned long clientOrderId)
+    {
+        mSent.push_back("cancel " + std::to_string(clientOrderId));
+    }
+
+    void execute_quote(const PendingQuote& quote)
+    {
+        mSent.push_back(std::string("quote ") + (quote.mSide == Side::BUY ? "buy " : "sell ")
+                        + std::to_string(quote.mPrice));
+    }
+
+    bool can_add_order() { return mCanAddOrder; }
+
+    std::vector<std::string> mSent;
+    bool mCanAddOrder = true;
+};
+
+// A scheduler whose clock only moves when the test says so.
+struct Fixture
+{
+    Fixture() : mStart(mTimers.Now()), mLimiter(mTimers, LIMIT, 1s), mScheduler(mSink, mLimiter, LIMIT, QUOTE_RESERVE) {}
+
+    // Use up the whole message limit now.
+    void Fill()
+    {
+        for (std::size_t i = 0; i < LIMIT; ++i)
+            mLimiter.Record();
+    }
+
+    // Move past the point where everything recorded at the start expires.
+    void ExpireStart() { mTimers.AdvanceTo(mStart + 1s + 1ms); }
+
+    ReplayTimerSource mTimers;
+    ReplayTimerSource::Clock::time_point mStart;
+    RateLimiter mLimiter;
+    Sink mSink;
+    ActionScheduler<Sink> mScheduler;
+};
+
+PendingQuote makeQuote(Side side, unsigned long price)
+{
+    PendingQuote quote;
+    quote.mSide = side;
+    quote.mPrice = price;
+    quote.mVolume = 10;
+    return quote;
+}
+
+using Sent = std::vector<std::string>;
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(actionscheduler, Fixture)
+
+BOOST_AUTO_TEST_CASE(sends_straight_away_when_there_is_room)
+{
+    mScheduler.Hedge(Side::SELL, 3);
+    mScheduler.Cancel(7);
+    mScheduler.Quote(makeQuote(Side::BUY, 100));
+    BOOST_TEST(mSink.mSent == (Sent{"hedge sell 3", "cancel 7", "quote buy 100"}));
+    BOOST_TEST(mLimiter.GetUsed() == 3u);
+}
+
+BOOST_AUTO_TEST_CASE(hedges_go_before_cancels_and_cancels_before_quotes)
+{
+    Fill();
+    mScheduler.Quote(makeQuote(Side::BUY, 100));
+    mScheduler.Cancel(7);
+    mScheduler.Hedge(Side::SELL, 3);
+    BOOST_TEST(mSink.mSent.empty());
+
+    ExpireStart();
+    BOOST_TEST(mSink.mSent == (Sent{"hedge sell 3", "cancel 7", "quote buy 100"}));
+}
+
+BOOST_AUTO_TEST_CASE(opposite_hedges_are_netted_into_one_order)
+{
+    Fill();
+    mScheduler.Hedge(Side::BUY, 5);
+    mScheduler.Hedge(Side::SELL, 2);
+    ExpireStart();
+    BOOST_TEST(mSink.mSent == (Sent{"hedge buy 3"}));
+    BOOST_TEST(mLimiter.GetUsed() == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(hedges_that_cancel_out_send_nothing)
+{
+    Fill();
+    mScheduler.Hedge(Side::BUY, 4);
+    mScheduler.Hedge(Side::SELL, 4);
+    ExpireStart();
+    BOOST_TEST(mSink.mSent.empty());
+    BOOST_TEST(mLimiter.GetUsed() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(an_order_is_cancelled_once)
+{
+    Fill();
+    mScheduler.Cancel(7);
+    mScheduler.Cancel(7);
+    mScheduler.Cancel(8);
+    BOOST_TEST(mScheduler.IsCancelPending(7));
+    BOOST_TEST(mScheduler.IsCancelPending(8));
+
+    mScheduler.DropCancel(8);
+    BOOST_TEST(!mScheduler.IsCancelPending(8));
+
+    ExpireStart();
+    BOOST_TEST(mSink.mSent == (Sent{"cancel 7"}));
+    BOOST_TEST(!mScheduler.IsCancelPending(7));
+}
+
+BOOST_AUTO_TEST_CASE(a_new_quote_replaces_an_unsent_one_on_the_same_side)
+{
+    Fill();
+    mScheduler.Quote(makeQuote(Side::BUY, 100));
+    mScheduler.Quote(makeQuote(Side::SELL, 200));
+    mScheduler.Quote(makeQuote(Side::BUY, 101));
+    BOOST_TEST(mScheduler.GetHeldQuoteCount() == 2u);
+    BOOST_TEST(mScheduler.IsQuoteHeld(Side::BUY));
+
+    ExpireStart();
+    BOOST_TEST(mSink.mSent == (Sent{"quote sell 200", "quote buy 101"}));
+    BOOST_TEST(mScheduler.GetHeldQuoteCount() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(quotes_leave_the_reserve_for_hedges_and_cancels)
+{
+    for (std::size_t i = 0; i + QUOTE_RESERVE < LIMIT; ++i)
+        mLimiter.Record();
+    BOOST_TEST(!mScheduler.HasRoomForQuote());
+
+    mScheduler.Quote(makeQuote(Side::BUY, 100));
+    BOOST_TEST(mSink.mSent.empty());
+    BOOST_TEST(mScheduler.IsQuoteHeld(Side::BUY));
+
+    // The reserve is still there for a hedge.
+    mScheduler.Hedge(Side::SELL, 2);
+    BOOST_TEST(mSink.mSent == (Sent{"hedge sell 2"}));
+    BOOST_TEST(mLimiter.GetUsed() == LIMIT);
+
+    ExpireStart();
+    BOOST_TEST(mSink.mSent == (Sent{"hedge sell 2", "quote buy 100"}));
+}
+
+BOOST_AUTO_TEST_CASE(a_quote_is_dropped_when_no_order_can_be_added)
+{
+    mSink.mCanAddOrder = false;
+    mScheduler.Quote(makeQuote(Side::BUY, 100));
+    BOOST_TEST(mSink.mSent.empty());
+    BOOST_TEST(!mScheduler.IsQuoteHeld(Side::BUY));
+    BOOST_TEST(mLimiter.GetUsed() == 0u);
+
+    // Nothing is left to send once there is room again.
+    mSink.mCanAddOrder = true;
+    mTimers.AdvanceTo(mStart + 5s);
+    BOOST_TEST(mSink.mSent.empty());
+}
+
+BOOST_AUTO_TEST_CASE(a_blocked_drain_resumes_as_messages_expire)
+{
+    mLimiter.Record();
+    mLimiter.Record();
+    mTimers.AdvanceTo(mStart + 500ms);
+    mLimiter.Record();
+    mLimiter.Record();
+
+    mScheduler.Cancel(1);
+    mScheduler.Cancel(2);
+    mScheduler.Cancel(3);
+    BOOST_TEST(mSink.mSent.empty());
+
+    mTimers.AdvanceTo(mStart + 1s);
+    BOOST_TEST(mSink.mSent.empty());
+
+    // Two messages leave the window, making room for two cancels.
+    mTimers.AdvanceTo(mStart + 1s + 1ms);
+    BOOST_TEST(mSink.mSent == (Sent{"cancel 1", "cancel 2"}));
+
+    mTimers.AdvanceTo(mStart + 1500ms + 1ms);
+    BOOST_TEST(mSink.mSent == (Sent{"cancel 1", "cancel 2", "cancel 3"}));
+    BOOST_TEST(!mTimers.RunNext());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,149 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <boost/endian/conversion.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <ready_trader_go/byteswap.h>
+#include <ready_trader_go/protocol.h>
+
+using namespace ReadyTraderGo;
+
+namespace {
+
+constexpr std::size_t MAXIMUM_COUNT = 24;
+constexpr std::size_t MAXIMUM_OFFSET = 16;
+constexpr unsigned long GUARD = 0xdeadbeefcafef00dUL;
+
+// Bytes that make every value different and exercise every byte position,
+// including values with the top bit set.
+std::vector<unsigned char> makeInput(std::size_t size)
+{
+    std::vector<unsigned char> input(size);
+    for (std::size_t i = 0; i < size; ++i)
+        input[i] = static_cast<unsigned char>(i * 37 + 0x81);
+    return input;
+}
+
+// Uses each decoder in turn for the messages decoded in its scope.
+struct ActiveDecoder
+{
+    explicit ActiveDecoder(const BigEndianDecoder& decoder) : mPrevious(activeBigEndianDecoder)
+    {
+        activeBigEndianDecoder = decoder;
+    }
+    ~ActiveDecoder() { activeBigEndianDecoder = mPrevious; }
+
+    BigEndianDecoder mPrevious;
+};
+
+template<typename Message>
+void checkLayout(const BigEndianDecoder& decoder)
+{
+    using Layout = typename MessageTraits<Message>::Layout;
+
+    for (std::size_t offset = 0; offset < MAXIMUM_OFFSET; ++offset)
+    {
+        // The message ends exactly where the buffer does.
+        const std::vector<unsigned char> input = makeInput(offset + Layout::SIZE);
+        unsigned char const* data = input.data() + offset;
+
+        Message message;
+        {
+            ActiveDecoder active(decoder);
+            Layout::Decode(message, data);
+        }
+
+        const std::size_t askPrices = Layout::template OffsetOf<&Message::mAskPrices>();
+        const std::size_t askVolumes = Layout::template OffsetOf<&Message::mAskVolumes>();
+        const std::size_t bidPrices = Layout::template OffsetOf<&Message::mBidPrices>();
+        const std::size_t bidVolumes = Layout::template OffsetOf<&Message::mBidVolumes>();
+        for (std::size_t i = 0; i < TOP_LEVEL_COUNT; ++i)
+        {
+            BOOST_TEST(message.mAskPrices[i] == boost::endian::load_big_u32(data + askPrices + i * 4));
+            BOOST_TEST(message.mAskVolumes[i] == boost::endian::load_big_u32(data + askVolumes + i * 4));
+            BOOST_TEST(message.mBidPrices[i] == boost::endian::load_big_u32(data + bidPrices + i * 4));
+            BOOST_TEST(message.mBidVolumes[i] == boost::endian::load_big_u32(data + bidVolumes + i * 4));
+        }
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(byteswap)
+
+BOOST_AUTO_TEST_CASE(scalar_decoder_is_always_supported)
+{
+    const std::vector<BigEndianDecoder> decoders = supportedBigEndianDecoders();
+    BOOST_REQUIRE(!decoders.empty());
+    BOOST_TEST(decoders.front().mDecode == &decodeBigEndianScalar);
+}
+
+BOOST_AUTO_TEST_CASE(active_decoder_is_the_fastest_supported)
+{
+    BOOST_TEST(activeBigEndianDecoder.mDecode == supportedBigEndianDecoders().back().mDecode);
+}
+
+// Every count up to a few vectors' worth, so that every length of tail is
+// covered, from every alignment, with the input ending where its buffer
+// does and the output checked for writes past the end.
+BOOST_AUTO_TEST_CASE(decoders_match_scalar_decoder)
+{
+    for (const BigEndianDecoder& decoder : supportedBigEndianDecoders())
+    {
+        BOOST_TEST_CONTEXT("decoder " << decoder.mName)
+        {
+            for (std::size_t count = 0; count <= MAXIMUM_COUNT; ++count)
+            {
+                for (std::size_t offset = 0; offset < MAXIMUM_OFFSET; ++offset)
+                {
+                    BOOST_TEST_CONTEXT("count " << count << " offset " << offset)
+                    {
+                        const std::vector<unsigned char> input = makeInput(offset + count * 4);
+                        unsigned char const* data = input.data() + offset;
+
+                        std::vector<unsigned long> expected(count + 4, GUARD);
+                        decodeBigEndianScalar(data, expected.data(), count);
+
+                        std::vector<unsigned long> values(count + 4, GUARD);
+                        decoder.mDecode(data, values.data(), count);
+
+                        BOOST_TEST(values == expected, boost::test_tools::per_element());
+                    }
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(layouts_match_scalar_decoder)
+{
+    for (const BigEndianDecoder& decoder : supportedBigEndianDecoders())
+    {
+        BOOST_TEST_CONTEXT("decoder " << decoder.mName)
+        {
+            checkLayout<OrderBookMessage>(decoder);
+            checkLayout<TradeTicksMessage>(decoder);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,143 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/multicast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <ready_trader_go/connectivity.h>
+#include <ready_trader_go/protocol.h>
+
+using namespace ReadyTraderGo;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr char GROUP[] = "239.255.77.1:47231";
+
+template<typename Message>
+Message makeMessage(Instrument instrument, unsigned long sequenceNumber)
+{
+    std::array<unsigned long, TOP_LEVEL_COUNT> askPrices{}, askVolumes{}, bidPrices{}, bidVolumes{};
+    for (std::size_t i = 0; i < TOP_LEVEL_COUNT; ++i)
+    {
+        askPrices[i] = 100100 + i * 100;
+        askVolumes[i] = 10 + i;
+        bidPrices[i] = 99900 - i * 100;
+        bidVolumes[i] = 20 + i;
+    }
+    return Message(instrument, sequenceNumber, askPrices, askVolumes, bidPrices, bidVolumes);
+}
+
+template<typename Message>
+void checkMessage(const Message& actual, const Message& expected)
+{
+    BOOST_TEST((actual.mInstrument == expected.mInstrument));
+    BOOST_TEST(actual.mSequenceNumber == expected.mSequenceNumber);
+    BOOST_TEST(actual.mAskPrices == expected.mAskPrices);
+    BOOST_TEST(actual.mAskVolumes == expected.mAskVolumes);
+    BOOST_TEST(actual.mBidPrices == expected.mBidPrices);
+    BOOST_TEST(actual.mBidVolumes == expected.mBidVolumes);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(connectivity)
+
+BOOST_AUTO_TEST_CASE(udp_subscription_decodes_published_messages)
+{
+    boost::asio::io_context context;
+    SubscriptionFactory factory(context, "udp", GROUP);
+    auto subscription = factory.Create();
+
+    std::vector<OrderBookMessage> books;
+    std::vector<TradeTicksMessage> ticks;
+    subscription->MessageReceived = [&](ISubscription*, unsigned char type, unsigned char const* data, std::size_t size) {
+        if (type == static_cast<unsigned char>(MessageType::ORDER_BOOK_UPDATE))
+        {
+            BOOST_TEST(size == OrderBookMessage().Size());
+            books.emplace_back();
+            books.back().Deserialise(data, size);
+        }
+        else if (type == static_cast<unsigned char>(MessageType::TRADE_TICKS))
+        {
+            BOOST_TEST(size == TradeTicksMessage().Size());
+            ticks.emplace_back();
+            ticks.back().Deserialise(data, size);
+        }
+        else
+        {
+            BOOST_ERROR("unexpected message type " << static_cast<int>(type));
+        }
+    };
+    subscription->AsyncReceive();
+
+    const auto book = makeMessage<OrderBookMessage>(Instrument::ETF, 7);
+    const auto tick = makeMessage<TradeTicksMessage>(Instrument::FUTURE, 8);
+    MulticastPublisher publisher(context, parseMulticastGroup(GROUP));
+    publisher.Publish(static_cast<unsigned char>(MessageType::ORDER_BOOK_UPDATE), book);
+    publisher.Publish(static_cast<unsigned char>(MessageType::TRADE_TICKS), tick);
+
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while ((books.empty() || ticks.empty()) && std::chrono::steady_clock::now() < deadline)
+        context.run_for(10ms);
+
+    BOOST_TEST_REQUIRE(books.size() == 1u);
+    BOOST_TEST_REQUIRE(ticks.size() == 1u);
+    checkMessage(books.front(), book);
+    checkMessage(ticks.front(), tick);
+}
+
+BOOST_AUTO_TEST_CASE(udp_subscription_ignores_datagrams_shorter_than_the_header)
+{
+    boost::asio::io_context context;
+    SubscriptionFactory factory(context, "udp", GROUP);
+    auto subscription = factory.Create();
+
+    std::vector<unsigned char> types;
+    subscription->MessageReceived = [&](ISubscription*, unsigned char type, unsigned char const*, std::size_t) {
+        types.push_back(type);
+    };
+    subscription->AsyncReceive();
+
+    const udp::endpoint group = parseMulticastGroup(GROUP);
+    udp::socket socket(context, udp::v4());
+    socket.set_option(boost::asio::ip::multicast::outbound_interface(boost::asio::ip::address_v4::loopback()));
+    socket.set_option(boost::asio::ip::multicast::enable_loopback(true));
+    const unsigned char runt[] = {0x00};
+    socket.send_to(boost::asio::buffer(runt, 0), group);
+    socket.send_to(boost::asio::buffer(runt, 1), group);
+
+    MulticastPublisher publisher(context, group);
+    publisher.Publish(static_cast<unsigned char>(MessageType::TRADE_TICKS),
+                      makeMessage<TradeTicksMessage>(Instrument::ETF, 1));
+
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (types.empty() && std::chrono::steady_clock::now() < deadline)
+        context.run_for(10ms);
+    context.run_for(10ms);
+
+    BOOST_TEST(types == (std::vector<unsigned char>{static_cast<unsigned char>(MessageType::TRADE_TICKS)}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
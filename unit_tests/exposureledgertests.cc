@@ -0,0 +1,126 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <boost/test/unit_test.hpp>
+
+#include <ready_trader_go/types.h>
+
+#include "exposureledger.h"
+#include "ordertable.h"
+
+using ReadyTraderGo::Side;
+
+namespace {
+
+// Keeps a ledger and an order table in step, as AutoTrader does.
+struct Book
+{
+    void Insert(unsigned long clientOrderId, Side side, unsigned long volume)
+    {
+        BOOST_TEST_REQUIRE(mOrders.Insert(clientOrderId, side, 100, volume, 0) != nullptr);
+        mLedger.OnInsert(side, volume);
+    }
+
+    void Fill(unsigned long clientOrderId, unsigned long volume)
+    {
+        OrderTable::Order* order = mOrders.Find(clientOrderId);
+        BOOST_TEST_REQUIRE(order != nullptr);
+        mLedger.OnFill(order->mSide, volume);
+        order->mRemainingVolume -= volume;
+    }
+
+    void Done(unsigned long clientOrderId)
+    {
+        const OrderTable::Order* order = mOrders.Find(clientOrderId);
+        BOOST_TEST_REQUIRE(order != nullptr);
+        mLedger.OnDone(order->mSide, order->mRemainingVolume);
+        mOrders.Remove(clientOrderId);
+    }
+
+    void Check() const
+    {
+        BOOST_TEST(mLedger.PendingVolume(Side::BUY) == mOrders.RemainingVolume(Side::BUY));
+        BOOST_TEST(mLedger.PendingVolume(Side::SELL) == mOrders.RemainingVolume(Side::SELL));
+        BOOST_TEST(mLedger.ActiveOrderCount() == mOrders.Size());
+        mLedger.Verify(mOrders);
+    }
+
+    OrderTable mOrders;
+    ExposureLedger mLedger;
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE(exposureledger)
+
+BOOST_AUTO_TEST_CASE(insert_adds_pending_volume_and_an_active_order)
+{
+    Book book;
+    book.Insert(1, Side::BUY, 10);
+    book.Insert(2, Side::BUY, 5);
+    book.Insert(3, Side::SELL, 7);
+    book.Check();
+    BOOST_TEST(book.mLedger.PendingVolume(Side::BUY) == 15u);
+    BOOST_TEST(book.mLedger.PendingVolume(Side::SELL) == 7u);
+    BOOST_TEST(book.mLedger.ActiveOrderCount() == 3u);
+    BOOST_TEST(book.mLedger.Position() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(fills_move_pending_volume_into_the_position)
+{
+    Book book;
+    book.Insert(1, Side::BUY, 10);
+    book.Insert(2, Side::SELL, 7);
+
+    book.Fill(1, 4);
+    book.Check();
+    BOOST_TEST(book.mLedger.Position() == 4);
+    BOOST_TEST(book.mLedger.PendingVolume(Side::BUY) == 6u);
+
+    book.Fill(2, 7);
+    book.Check();
+    BOOST_TEST(book.mLedger.Position() == -3);
+    BOOST_TEST(book.mLedger.PendingVolume(Side::SELL) == 0u);
+
+    // A fully filled order stays active until the exchange says it is done.
+    BOOST_TEST(book.mLedger.ActiveOrderCount() == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(done_releases_the_untraded_volume)
+{
+    Book book;
+    book.Insert(1, Side::BUY, 10);
+    book.Insert(2, Side::SELL, 7);
+    book.Fill(1, 4);
+    book.Fill(2, 7);
+
+    // Cancelled with volume left.
+    book.Done(1);
+    book.Check();
+    BOOST_TEST(book.mLedger.PendingVolume(Side::BUY) == 0u);
+    BOOST_TEST(book.mLedger.ActiveOrderCount() == 1u);
+
+    // Fully filled.
+    book.Done(2);
+    book.Check();
+    BOOST_TEST(book.mLedger.ActiveOrderCount() == 0u);
+
+    // The position outlives the orders that made it.
+    BOOST_TEST(book.mLedger.Position() == -3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,98 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <ready_trader_go/types.h>
+
+#include "ordertable.h"
+
+using ReadyTraderGo::Side;
+
+BOOST_AUTO_TEST_SUITE(ordertable)
+
+BOOST_AUTO_TEST_CASE(insert_until_full)
+{
+    OrderTable orders;
+    for (unsigned long id = 1; id <= OrderTable::CAPACITY; ++id)
+    {
+        BOOST_TEST(!orders.Full());
+        OrderTable::Order* order = orders.Insert(id, Side::BUY, 100 * id, id, id + 1000);
+        BOOST_TEST_REQUIRE(order != nullptr);
+        BOOST_TEST(order->mClientOrderId == id);
+        BOOST_TEST(order->mPrice == 100 * id);
+        BOOST_TEST(order->mRemainingVolume == id);
+        BOOST_TEST(order->mSequenceNumber == id + 1000);
+        BOOST_TEST((order->mState == OrderTable::State::LIVE));
+    }
+    BOOST_TEST(orders.Full());
+    BOOST_TEST(orders.Size() == OrderTable::CAPACITY);
+    BOOST_TEST(orders.Insert(99, Side::SELL, 100, 1, 0) == nullptr);
+
+    // A removed order frees its slot.
+    orders.Remove(3);
+    BOOST_TEST(!orders.Full());
+    BOOST_TEST(orders.Insert(99, Side::SELL, 100, 1, 0) != nullptr);
+    BOOST_TEST(orders.Full());
+}
+
+BOOST_AUTO_TEST_CASE(find_and_remove)
+{
+    OrderTable orders;
+    orders.Insert(1, Side::BUY, 100, 5, 0);
+    orders.Insert(2, Side::SELL, 200, 6, 0);
+
+    BOOST_TEST_REQUIRE(orders.Find(2) != nullptr);
+    BOOST_TEST(orders.Find(2)->mPrice == 200u);
+    BOOST_TEST(orders.Find(3) == nullptr);
+
+    orders.Remove(1);
+    BOOST_TEST(orders.Find(1) == nullptr);
+    BOOST_TEST(orders.Size() == 1u);
+
+    // Removing an unknown or already removed order changes nothing.
+    orders.Remove(1);
+    orders.Remove(3);
+    BOOST_TEST(orders.Size() == 1u);
+    BOOST_TEST(orders.Find(2) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(remaining_volume_per_side)
+{
+    OrderTable orders;
+    orders.Insert(1, Side::BUY, 100, 5, 0);
+    orders.Insert(2, Side::BUY, 101, 7, 0);
+    orders.Insert(3, Side::SELL, 102, 11, 0);
+    BOOST_TEST(orders.RemainingVolume(Side::BUY) == 12u);
+    BOOST_TEST(orders.RemainingVolume(Side::SELL) == 11u);
+
+    orders.Find(2)->mRemainingVolume -= 4;
+    orders.Find(3)->mState = OrderTable::State::CANCELLING;
+    BOOST_TEST(orders.RemainingVolume(Side::BUY) == 8u);
+    BOOST_TEST(orders.RemainingVolume(Side::SELL) == 11u);
+
+    orders.Remove(1);
+    BOOST_TEST(orders.RemainingVolume(Side::BUY) == 3u);
+
+    std::vector<unsigned long> sells;
+    orders.ForEach(Side::SELL, [&sells](OrderTable::Order& order) { sells.push_back(order.mClientOrderId); });
+    BOOST_TEST(sells == (std::vector<unsigned long>{3}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,94 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <boost/test/unit_test.hpp>
+
+#include <ready_trader_go/types.h>
+
+#include "pairedbooks.h"
+
+using ReadyTraderGo::Instrument;
+
+namespace {
+
+PairedBooks::TopOfBook makeTop(unsigned long mid)
+{
+    PairedBooks::TopOfBook top;
+    top.mMid = mid;
+    top.mBestAskPrice = mid + 100;
+    top.mBestAskVolume = 10;
+    top.mBestBidPrice = mid - 100;
+    top.mBestBidVolume = 20;
+    return top;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(pairedbooks)
+
+BOOST_AUTO_TEST_CASE(store_find_and_erase)
+{
+    PairedBooks books;
+    BOOST_TEST(books.Find(Instrument::ETF, 1) == nullptr);
+
+    books.Store(Instrument::ETF, 1, makeTop(10000));
+    BOOST_TEST(books.Find(Instrument::FUTURE, 1) == nullptr);
+    BOOST_TEST_REQUIRE(books.Find(Instrument::ETF, 1) != nullptr);
+    BOOST_TEST(books.Find(Instrument::ETF, 1)->mMid == 10000u);
+
+    books.Store(Instrument::FUTURE, 1, makeTop(10100));
+    BOOST_TEST_REQUIRE(books.Find(Instrument::FUTURE, 1) != nullptr);
+    BOOST_TEST(books.Find(Instrument::FUTURE, 1)->mBestAskPrice == 10200u);
+    BOOST_TEST(books.Find(Instrument::ETF, 1)->mMid == 10000u);
+
+    // A later store for the same sequence number replaces the book.
+    books.Store(Instrument::ETF, 1, makeTop(10050));
+    BOOST_TEST(books.Find(Instrument::ETF, 1)->mMid == 10050u);
+
+    books.Erase(1);
+    BOOST_TEST(books.Find(Instrument::ETF, 1) == nullptr);
+    BOOST_TEST(books.Find(Instrument::FUTURE, 1) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(wrapped_sequence_number_evicts_the_stale_slot)
+{
+    PairedBooks books;
+    books.Store(Instrument::ETF, 3, makeTop(10000));
+    books.Store(Instrument::FUTURE, 3, makeTop(10100));
+    books.Store(Instrument::ETF, 4, makeTop(10200));
+
+    // Shares sequence number 3's slot.
+    const unsigned long wrapped = 3 + PairedBooks::CAPACITY;
+    BOOST_TEST(books.Find(Instrument::ETF, wrapped) == nullptr);
+
+    books.Store(Instrument::FUTURE, wrapped, makeTop(10300));
+    BOOST_TEST(books.Find(Instrument::ETF, 3) == nullptr);
+    BOOST_TEST(books.Find(Instrument::FUTURE, 3) == nullptr);
+    BOOST_TEST(books.Find(Instrument::ETF, wrapped) == nullptr);
+    BOOST_TEST_REQUIRE(books.Find(Instrument::FUTURE, wrapped) != nullptr);
+    BOOST_TEST(books.Find(Instrument::FUTURE, wrapped)->mMid == 10300u);
+
+    // Erasing the stale sequence number leaves the newer one alone.
+    books.Erase(3);
+    BOOST_TEST(books.Find(Instrument::FUTURE, wrapped) != nullptr);
+
+    // Other slots are untouched.
+    BOOST_TEST_REQUIRE(books.Find(Instrument::ETF, 4) != nullptr);
+    BOOST_TEST(books.Find(Instrument::ETF, 4)->mMid == 10200u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <chrono>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <ready_trader_go/ratelimiter.h>
+#include <ready_trader_go/replay.h>
+
+using namespace ReadyTraderGo;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(ratelimiter)
+
+BOOST_AUTO_TEST_CASE(submit_defers_sends_until_the_window_has_room)
+{
+    ReplayTimerSource timers;
+    const auto start = timers.Now();
+    RateLimiter limiter(timers, 2, 1s);
+
+    std::vector<int> sent;
+    for (int i = 0; i < 3; ++i)
+        limiter.Submit([&sent, i]() { sent.push_back(i); });
+    BOOST_TEST(sent == (std::vector<int>{0, 1}));
+    BOOST_TEST(limiter.GetUsed() == 3u);
+    BOOST_TEST(limiter.GetQueued() == 1u);
+
+    // A message leaves the window once it is strictly older than it.
+    timers.AdvanceTo(start + 1s);
+    BOOST_TEST(sent.size() == 2u);
+
+    timers.AdvanceTo(start + 2s);
+    BOOST_TEST(sent == (std::vector<int>{0, 1, 2}));
+    BOOST_TEST(limiter.GetQueued() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(notify_on_expiry_runs_when_the_oldest_message_expires)
+{
+    ReplayTimerSource timers;
+    const auto start = timers.Now();
+    RateLimiter limiter(timers, 2, 1s);
+
+    limiter.Record();
+    timers.AdvanceTo(start + 500ms);
+    limiter.Record();
+
+    int calls = 0;
+    limiter.NotifyOnExpiry([&]() {
+        ++calls;
+        BOOST_TEST(limiter.GetUsed() == 1u);
+    });
+    timers.AdvanceTo(start + 1s);
+    BOOST_TEST(calls == 0);
+    timers.AdvanceTo(start + 1200ms);
+    BOOST_TEST(calls == 1);
+    timers.AdvanceTo(start + 3s);
+    BOOST_TEST(calls == 1);
+}
+
+BOOST_AUTO_TEST_CASE(waiting_timers_run_after_the_journal_ends)
+{
+    ReplayTimerSource timers;
+    RateLimiter limiter(timers, 1, 1s);
+
+    int sent = 0;
+    limiter.Submit([&]() { ++sent; });
+    limiter.Submit([&]() { ++sent; });
+    BOOST_TEST(sent == 1);
+
+    while (timers.RunNext())
+        continue;
+    BOOST_TEST(sent == 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()